@@ -0,0 +1,333 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "analysisplan.h"
+
+#include <assert.h>
+#include <math.h>
+#include <algorithm>
+
+#include "constants.h"
+
+// TargetFrequencyParameter is a constant which implies the index at which
+// corresponds to the target frequency. 0.5 * N * 1 / TargetFrequencyParameter
+// is (about) the index which corresponds to the given target frequency.
+// Effectively TargetFrequencyParameter = 2^z, and the z * TargetFrequency
+// is the maximum frequency that can be noticed.
+const static int TargetFrequencyParameter(4);
+
+// Length of the attack transient which is left out of the frame following
+// an onset.
+const static double TransientMilliseconds(10.0);
+
+
+/*!
+  \class AnalysisPlan
+  \brief Everything the analyzer needs for measuring a set of strings,
+         computed once.
+
+  A plan is made for each string of a tuning, and one wide-band plan for all
+  the strings of the tuning, when the tuning is set. The plan holds the
+  decimation, the frame length, the FFT initialised for the frame length,
+  the band of indices searched for the peak, the rates of the onset detector,
+  and a table of the nearest string and the voice difference from it for
+  each index, with the derivatives of the voice difference for peaks between
+  the indices. Switching between the plans does no computation, and
+  measuring a frame takes no logarithms.
+
+  The samples are decimated for the highest string, or by a given smaller
+  step, and the frame is long enough for the precision at the lowest string.
+  The samples of a plan can be continued by a plan whose step is a multiple
+  of its step, so the analyzer can switch between them without dropping the
+  samples collected so far. The band reaches log_2(TargetFrequencyParameter)
+  octaves below the lowest string; a peak below it is not a voice of any of
+  the strings.
+*/
+
+
+/*!
+  Constructor. Makes a plan for measuring the strings of \a frequencies from
+  data in \a format. \a strings tells the index of each string in the tuning.
+  \a precisionPerNote is the precision in notes near the lowest string, and
+  \a maximumVoiceDifference the value of a voice outside the range. If
+  \a stepSize is given, the samples are decimated by it instead of for the
+  highest string, and the frame is made longer by the same factor; it must
+  not decimate more than the highest string allows.
+*/
+AnalysisPlan::AnalysisPlan(const PcmFormat &format,
+                           const std::vector<double> &frequencies,
+                           const std::vector<int> &strings,
+                           int precisionPerNote,
+                           int maximumVoiceDifference,
+                           int stepSize)
+    : m_strings(strings),
+      m_stepSize(1),
+      m_totalSampleCount(0),
+      m_firstIndex(1),
+      m_lastIndex(0),
+      m_transientSkip(0),
+      m_frameDuration(0),
+      m_indexToFrequency(0),
+      m_noisePeakFactor(0)
+{
+    assert(format.isValid());
+    assert(!frequencies.empty() && frequencies.size() == strings.size());
+    assert(precisionPerNote > 0);
+
+    const double highest = *std::max_element(frequencies.begin(),
+                                             frequencies.end());
+    const double lowest = *std::min_element(frequencies.begin(),
+                                            frequencies.end());
+    assert(lowest > 0);
+
+    const int highestStep = maximumStepSize(format, highest);
+    assert(stepSize >= 0 && stepSize <= highestStep);
+    m_stepSize = stepSize > 0 ? stepSize : highestStep;
+    m_totalSampleCount = (int)lround(double(precisionPerNote)
+                                     * TargetFrequencyParameter
+                                     * M_SAMPLE_COUNT_MULTIPLIER);
+
+    // Keep the precision at the lowest string, at the rate of the step. The
+    // length is rounded up to one the FFT is fast for: e.g. 538 = 2 * 269
+    // would take a slow DFT of 269 points.
+    const double lengthFactor = highest / lowest * highestStep / m_stepSize;
+    m_totalSampleCount = FastFourierTransformer::optimalSize(
+                (int)ceil(m_totalSampleCount * lengthFactor));
+
+    const double decimatedRate = double(format.sampleRate) / m_stepSize;
+    const int halfN = m_totalSampleCount / 2;
+
+    m_fftHelper.reserve(m_totalSampleCount);
+    m_onsetRates = OnsetDetector::ratesForSampleRate(decimatedRate);
+    m_transientSkip = (int)lround(TransientMilliseconds * decimatedRate / 1000);
+    m_frameDuration = m_totalSampleCount / decimatedRate;
+    m_indexToFrequency = decimatedRate / m_totalSampleCount;
+
+    // For white noise of energy E per sample, the expected squared density of
+    // a bin is N * E, and the largest of the N / 2 bins is about
+    // N * E * ln(N / 2).
+    m_noisePeakFactor = m_totalSampleCount * log(m_totalSampleCount / 2.0);
+
+    m_firstIndex = std::max(1, (int)floor(lowest / TargetFrequencyParameter
+                                          / m_indexToFrequency));
+    m_lastIndex = halfN - 1;
+
+    const int stringCount = (int)frequencies.size();
+    m_stringCorrectIndex.resize(stringCount);
+
+    for (int i = 0; i < stringCount; ++i) {
+        m_stringCorrectIndex[i] =
+                (int)lround(frequencies[i] / m_indexToFrequency);
+    }
+
+    // Compute the nearest string and the voice difference from it for each
+    // index.
+    m_indexString.assign(halfN, 0);
+    m_indexVoiceDifference.assign(halfN, 0);
+    m_indexTargetDifference.assign(halfN, 0);
+    m_indexSlope.assign(halfN, 0);
+    m_indexCurvature.assign(halfN, 0);
+
+    for (int k = 1; k < halfN; ++k) {
+        const double frequency = k * m_indexToFrequency;
+        int nearest = 0;
+        double nearestDistance = fabs(log(frequency / frequencies[0]));
+
+        for (int i = 1; i < stringCount; ++i) {
+            const double distance = fabs(log(frequency / frequencies[i]));
+
+            if (distance < nearestDistance) {
+                nearest = i;
+                nearestDistance = distance;
+            }
+        }
+
+        const double target = frequencies[nearest];
+        float value = 0;
+        float targetValue = 0;
+
+        if (target > frequency * TargetFrequencyParameter) {
+            value = -maximumVoiceDifference;
+            targetValue = value;
+        }
+        else if (target * TargetFrequencyParameter < frequency) {
+            value = maximumVoiceDifference;
+            targetValue = value;
+        }
+        else {
+            // Use the correct index instead of the target frequency so that
+            // the value is zero when the correct voice is obtained.
+            value = log(double(k) / m_stringCorrectIndex[nearest]) * 12 / M_LN2;
+
+            // The interpolated peak is measured from the exact target, which
+            // falls between the indexes.
+            targetValue = log(frequency / target) * 12 / M_LN2;
+        }
+
+        m_indexString[k] = nearest;
+        m_indexVoiceDifference[k] = value;
+        m_indexTargetDifference[k] = targetValue;
+
+        if (fabs(value) < maximumVoiceDifference) {
+            // The first two derivatives of 12 * log_2(k / target index).
+            m_indexSlope[k] = 12 / (M_LN2 * k);
+            m_indexCurvature[k] = -6 / (M_LN2 * k * k);
+        }
+    }
+}
+
+
+/*!
+  Returns the largest decimation step of samples in \a format for a plan
+  whose highest string is at \a frequency.
+*/
+int AnalysisPlan::maximumStepSize(const PcmFormat &format, double frequency)
+{
+    return std::max(1, (int)(1.0 * format.sampleRate
+                             / (TargetFrequencyParameter * 2 * frequency)));
+}
+
+
+/*!
+  Returns the FFT initialised for the frame length.
+*/
+FastFourierTransformer &AnalysisPlan::fftHelper() const
+{
+    return m_fftHelper;
+}
+
+
+/*!
+  Returns the rates of the onset detector for the decimated samples.
+*/
+const OnsetDetector::Rates &AnalysisPlan::onsetRates() const
+{
+    return m_onsetRates;
+}
+
+
+/*!
+  Returns the decimation factor.
+*/
+int AnalysisPlan::stepSize() const
+{
+    return m_stepSize;
+}
+
+
+/*!
+  Returns the number of decimated samples in a frame.
+*/
+int AnalysisPlan::totalSampleCount() const
+{
+    return m_totalSampleCount;
+}
+
+
+/*!
+  Returns the lowest index searched for the peak.
+*/
+int AnalysisPlan::firstIndex() const
+{
+    return m_firstIndex;
+}
+
+
+/*!
+  Returns the highest index searched for the peak.
+*/
+int AnalysisPlan::lastIndex() const
+{
+    return m_lastIndex;
+}
+
+
+/*!
+  Returns the number of decimated samples skipped after an onset.
+*/
+int AnalysisPlan::transientSkip() const
+{
+    return m_transientSkip;
+}
+
+
+/*!
+  Returns the length of a frame in seconds.
+*/
+double AnalysisPlan::frameDuration() const
+{
+    return m_frameDuration;
+}
+
+
+/*!
+  Returns the frequency step between two consecutive indices.
+*/
+double AnalysisPlan::indexToFrequency() const
+{
+    return m_indexToFrequency;
+}
+
+
+/*!
+  Returns the expected peak density of white noise of unit energy.
+*/
+double AnalysisPlan::noisePeakFactor() const
+{
+    return m_noisePeakFactor;
+}
+
+
+/*!
+  Returns the number of strings in the plan.
+*/
+int AnalysisPlan::stringCount() const
+{
+    return (int)m_strings.size();
+}
+
+
+/*!
+  Returns the index in the tuning of the string nearest to \a index, or -1
+  if the plan was made for a frequency outside the tuning.
+*/
+int AnalysisPlan::string(int index) const
+{
+    return m_strings[m_indexString[index]];
+}
+
+
+/*!
+  Returns the index of the string nearest to \a index.
+*/
+int AnalysisPlan::correctIndex(int index) const
+{
+    return m_stringCorrectIndex[m_indexString[index]];
+}
+
+
+/*!
+  Returns the voice difference of \a index from the nearest string in
+  semitones, measured from the index of the string, so that it is zero at
+  the correct index.
+*/
+float AnalysisPlan::voiceDifference(int index) const
+{
+    return m_indexVoiceDifference[index];
+}
+
+
+/*!
+  Returns the voice difference of a peak \a offset indices from \a index,
+  from the exact frequency of the string nearest to \a index, in semitones.
+  The offset is between -0.5 and 0.5. Uses the Taylor series of the
+  logarithm up to the second degree, whose error is below 0.02 semitones
+  from the fourth index on.
+*/
+float AnalysisPlan::voiceDifference(int index, float offset) const
+{
+    return m_indexTargetDifference[index]
+            + offset * (m_indexSlope[index]
+                        + offset * m_indexCurvature[index]);
+}
@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef ANALYSISPLAN_H
+#define ANALYSISPLAN_H
+
+#include <vector>
+
+#include "fastfouriertransformer.h"
+#include "onsetdetector.h"
+#include "pcmformat.h"
+
+
+class AnalysisPlan
+{
+public:
+    AnalysisPlan(const PcmFormat &format,
+                 const std::vector<double> &frequencies,
+                 const std::vector<int> &strings,
+                 int precisionPerNote,
+                 int maximumVoiceDifference,
+                 int stepSize = 0);
+
+public:
+    FastFourierTransformer &fftHelper() const;
+    const OnsetDetector::Rates &onsetRates() const;
+    int stepSize() const;
+    int totalSampleCount() const;
+    int firstIndex() const;
+    int lastIndex() const;
+    int transientSkip() const;
+    double frameDuration() const;
+    double indexToFrequency() const;
+    double noisePeakFactor() const;
+    int stringCount() const;
+    int string(int index) const;
+    int correctIndex(int index) const;
+    float voiceDifference(int index) const;
+    float voiceDifference(int index, float offset) const;
+
+public:
+    static int maximumStepSize(const PcmFormat &format, double frequency);
+
+private:
+    // Not copyable
+    AnalysisPlan(const AnalysisPlan &);
+    AnalysisPlan &operator=(const AnalysisPlan &);
+
+private:
+    mutable FastFourierTransformer m_fftHelper;
+    OnsetDetector::Rates m_onsetRates;
+    std::vector<int> m_strings; // Index of each string in the tuning
+    std::vector<int> m_stringCorrectIndex; // Index of each string
+    std::vector<int> m_indexString; // Nearest string of each index
+    std::vector<float> m_indexVoiceDifference; // From the nearest string
+    std::vector<float> m_indexTargetDifference; // From its exact frequency
+    std::vector<float> m_indexSlope; // Of the voice difference per index
+    std::vector<float> m_indexCurvature; // Of the voice difference per index
+    int m_stepSize;
+    int m_totalSampleCount;
+    int m_firstIndex;
+    int m_lastIndex;
+    int m_transientSkip;
+    double m_frameDuration;
+    double m_indexToFrequency;
+    double m_noisePeakFactor;
+};
+
+#endif // ANALYSISPLAN_H
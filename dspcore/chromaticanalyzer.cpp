@@ -0,0 +1,285 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "chromaticanalyzer.h"
+
+#include <assert.h>
+#include <math.h>
+#include <algorithm>
+#include <utility>
+
+#include "tuning.h"
+
+// The range of the notes, from A0 (27.5 Hz) to C8 (4186 Hz), in semitones
+// from C0.
+const static int LowestNote(9);
+const static int HighestNote(96);
+
+// Number of the notes of each lane. Each lane covers two octaves, and the
+// frame is long enough for the precision at its lowest note, so each lane
+// up has frames about four times shorter. At 48 kHz the frames of the
+// lowest lane, A0 to G#2, are about 2.4 s long against about 0.8 s in the
+// auto mode on the standard tuning, so the low E of a guitar is read some
+// 2.4 s after it is plucked. The next lane, from A2, has 0.6 s frames.
+const static int NotesPerLane(24);
+
+// A frame is considered tonal if its peak density is this many times the
+// expected peak density of white noise of the same energy.
+const static double TonalPeakRatio(8.0);
+
+
+/*!
+  \class ChromaticReading
+  \brief The outcome of analyzing one frame of one lane of
+         ChromaticAnalyzer.
+*/
+
+
+/*!
+  Constructor.
+*/
+ChromaticReading::ChromaticReading()
+    : isGated(false),
+      isLowVoice(true),
+      isInBand(false),
+      isTonal(false),
+      isFastest(false),
+      index(-1),
+      correctIndex(-1),
+      note(-1),
+      voiceDifference(0),
+      interpolatedVoiceDifference(0),
+      frequency(0),
+      energy(0),
+      frameDuration(0),
+      streamPosition(0)
+{
+}
+
+
+/*!
+  \class ChromaticAnalyzer
+  \brief Finds the nearest note and the difference from it over the full
+         range of the notes from lowestNote() to highestNote().
+
+  A single frame can not cover the full range in real time: the precision at
+  the lowest notes would need a frame of seconds decimated for the highest
+  notes. Instead, the range is split to lanes of two octaves, analyzed at
+  multiple resolutions. Each lane has its own AnalysisPlan, whose strings are
+  the notes of the lane, and its own decimation, so the frames of the lanes
+  are equally long in samples but the frames of the higher lanes are
+  shorter in time.
+
+  The input is decimated by averaging the input samples of each decimated
+  sample, which attenuates the voices above the band of the lane. A lane
+  reports a note only if the highest peak of its frame is among its notes;
+  a lower peak belongs to a lower lane, and a higher one to a higher lane.
+
+  The note and the voice difference from it are looked up from the tables
+  of the plan, so measuring a frame takes no logarithms or divisions.
+*/
+
+
+/*!
+  Constructor. \a precisionPerNote is the precision in notes at the lowest
+  note of each lane, and \a maximumVoiceDifference the voice difference of
+  a voice outside the range.
+*/
+ChromaticAnalyzer::ChromaticAnalyzer(const PcmFormat &format,
+                                     int precisionPerNote,
+                                     int maximumVoiceDifference)
+    : m_format(format)
+{
+    assert(m_format.isValid());
+
+    for (int first = LowestNote; first <= HighestNote; first += NotesPerLane) {
+        const int last = std::min(HighestNote, first + NotesPerLane - 1);
+        std::vector<double> frequencies;
+        std::vector<int> notes;
+
+        for (int note = first; note <= last; ++note) {
+            frequencies.push_back(Tuning::noteFrequency(note));
+            notes.push_back(note);
+        }
+
+        Lane lane;
+        lane.plan.reset(new AnalysisPlan(m_format, frequencies, notes,
+                                         precisionPerNote,
+                                         maximumVoiceDifference));
+
+        const AnalysisPlan &plan = *lane.plan;
+        lane.samples.reserve(plan.totalSampleCount());
+        lane.sampleEnergy = 0;
+        lane.sum = 0;
+        lane.phase = 0;
+        lane.scale = 1.0f / plan.stepSize();
+        lane.inverseCount = 1.0 / plan.totalSampleCount();
+        lane.gateEnergy = 0;
+
+        // The notes of the lane reach half a semitone beyond the first and
+        // the last note.
+        const double halfSemitone = pow(2.0, 1 / 24.0);
+        lane.firstNoteIndex = std::max(
+                    plan.firstIndex(),
+                    (int)ceil(frequencies.front() / halfSemitone
+                              / plan.indexToFrequency()));
+        lane.lastNoteIndex = std::min(
+                    plan.lastIndex(),
+                    (int)floor(frequencies.back() * halfSemitone
+                               / plan.indexToFrequency()));
+
+        m_lanes.push_back(std::move(lane));
+    }
+}
+
+
+/*!
+  Returns the lowest note, in semitones from C0.
+*/
+int ChromaticAnalyzer::lowestNote()
+{
+    return LowestNote;
+}
+
+
+/*!
+  Returns the highest note, in semitones from C0.
+*/
+int ChromaticAnalyzer::highestNote()
+{
+    return HighestNote;
+}
+
+
+/*!
+  Drops the samples collected so far.
+*/
+void ChromaticAnalyzer::reset()
+{
+    for (size_t i = 0; i < m_lanes.size(); ++i) {
+        Lane &lane = m_lanes[i];
+        lane.samples.clear();
+        lane.sampleEnergy = 0;
+        lane.sum = 0;
+        lane.phase = 0;
+    }
+}
+
+
+/*!
+  Sets the density cut-off of each lane to be the larger of
+  \a minimumAmplitude times the frame length, and the expected peak density
+  of noise of \a noiseEnergy per sample. Derives the energy gate of each
+  lane from the cut-off, see PitchAnalyzer::updateCutOff().
+*/
+void ChromaticAnalyzer::setCutOff(double minimumAmplitude, double noiseEnergy)
+{
+    for (size_t i = 0; i < m_lanes.size(); ++i) {
+        Lane &lane = m_lanes[i];
+        const AnalysisPlan &plan = *lane.plan;
+        const double minimumCutOff = minimumAmplitude * plan.totalSampleCount();
+        double cutOffSquared = minimumCutOff * minimumCutOff;
+        const double noiseCutOffSquared = noiseEnergy * plan.noisePeakFactor();
+
+        if (noiseCutOffSquared > cutOffSquared) {
+            cutOffSquared = noiseCutOffSquared;
+        }
+
+        plan.fftHelper().setCutOffForDensity(sqrt(cutOffSquared));
+        lane.gateEnergy = 2.0 * cutOffSquared * lane.inverseCount;
+    }
+}
+
+
+/*!
+  Feeds \a data, \a length bytes of PCM in the format of the analyzer, to
+  each lane, and analyzes the frames which get full. \a streamPosition is the
+  position of the data in the stream. Appends a reading of each analyzed
+  frame to \a readings.
+*/
+void ChromaticAnalyzer::write(const char *data, int64_t length,
+                              int64_t streamPosition,
+                              std::vector<ChromaticReading> *readings)
+{
+    const int sampleSize = m_format.bytesPerFrame();
+    const unsigned char *ptr = reinterpret_cast<const unsigned char *>(data);
+    const int64_t sampleCount = length / sampleSize;
+    const int laneCount = (int)m_lanes.size();
+
+    for (int64_t i = 0; i < sampleCount; ++i) {
+        const int16_t input = pcmReadInt16(m_format, ptr + i * sampleSize);
+
+        for (int j = 0; j < laneCount; ++j) {
+            Lane &lane = m_lanes[j];
+            lane.sum += input;
+
+            if (++lane.phase < lane.plan->stepSize()) {
+                continue;
+            }
+
+            const int16_t sample = int16_t(lane.sum * lane.scale);
+            lane.sum = 0;
+            lane.phase = 0;
+            lane.samples.push_back(sample);
+            lane.sampleEnergy += int32_t(sample) * sample;
+
+            if ((int)lane.samples.size() == lane.plan->totalSampleCount()) {
+                ChromaticReading reading;
+                analyzeLane(lane, streamPosition + i + 1, &reading);
+                reading.isFastest = (j == laneCount - 1);
+                readings->push_back(reading);
+                lane.samples.clear();
+                lane.sampleEnergy = 0;
+            }
+        }
+    }
+}
+
+
+/*!
+  Analyzes the full frame of \a lane, ending at \a streamPosition, and fills
+  in \a reading.
+*/
+void ChromaticAnalyzer::analyzeLane(Lane &lane, int64_t streamPosition,
+                                    ChromaticReading *reading)
+{
+    const AnalysisPlan &plan = *lane.plan;
+    FastFourierTransformer &fftHelper = plan.fftHelper();
+
+    reading->energy = lane.sampleEnergy * lane.inverseCount;
+    reading->frameDuration = plan.frameDuration();
+    reading->streamPosition = streamPosition;
+
+    if (lane.sampleEnergy <= lane.gateEnergy) {
+        reading->isGated = true;
+        return;
+    }
+
+    fftHelper.calculateFFT(&lane.samples[0], (int)lane.samples.size());
+
+    // Search the whole frame, so that a peak of another lane is not taken
+    // for a peak of this lane.
+    const int index = fftHelper.getMaximumDensityIndex(1, plan.lastIndex());
+    reading->isTonal = fftHelper.getMaximumDensitySquared()
+            > TonalPeakRatio * plan.noisePeakFactor() * reading->energy;
+
+    if (index == -1) {
+        return;
+    }
+
+    reading->isLowVoice = false;
+    reading->index = index;
+
+    if (index < lane.firstNoteIndex || index > lane.lastNoteIndex) {
+        return;
+    }
+
+    reading->isInBand = true;
+    reading->correctIndex = plan.correctIndex(index);
+    reading->note = plan.string(index);
+    reading->voiceDifference = plan.voiceDifference(index);
+    reading->interpolatedVoiceDifference =
+            plan.voiceDifference(index, fftHelper.getPeakOffset(index));
+    reading->frequency = index * plan.indexToFrequency();
+}
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef CHROMATICANALYZER_H
+#define CHROMATICANALYZER_H
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "analysisplan.h"
+#include "pcmformat.h"
+
+
+struct ChromaticReading
+{
+    ChromaticReading();
+
+    bool isGated; // The FFT was skipped by the energy gate
+    bool isLowVoice; // No peak above the cut-off
+    bool isInBand; // The peak is among the notes of the lane
+    bool isTonal;
+    bool isFastest; // From the lane with the shortest frames
+    int index; // Index of the peak
+    int correctIndex; // Index of the note
+    int note; // In semitones from C0
+    double voiceDifference; // In semitones from the note
+    double interpolatedVoiceDifference; // Between the indices
+    double frequency;
+    double energy; // Mean of the squared samples
+    double frameDuration;
+    int64_t streamPosition; // End of the frame
+};
+
+
+class ChromaticAnalyzer
+{
+public:
+    ChromaticAnalyzer(const PcmFormat &format,
+                      int precisionPerNote,
+                      int maximumVoiceDifference);
+
+public:
+    static int lowestNote();
+    static int highestNote();
+    void reset();
+    void setCutOff(double minimumAmplitude, double noiseEnergy);
+    void write(const char *data, int64_t length, int64_t streamPosition,
+               std::vector<ChromaticReading> *readings);
+
+private:
+    struct Lane
+    {
+        std::unique_ptr<AnalysisPlan> plan;
+        std::vector<int16_t> samples;
+        int64_t sampleEnergy; // Sum of squares of samples
+        int32_t sum; // Of the input samples of the decimated sample
+        int phase; // Number of the input samples in sum
+        float scale; // 1 / stepSize
+        double inverseCount; // 1 / totalSampleCount
+        int firstNoteIndex; // The indices of the notes of the lane
+        int lastNoteIndex;
+        double gateEnergy;
+    };
+
+    void analyzeLane(Lane &lane, int64_t streamPosition,
+                     ChromaticReading *reading);
+
+private:
+    // Not copyable
+    ChromaticAnalyzer(const ChromaticAnalyzer &);
+    ChromaticAnalyzer &operator=(const ChromaticAnalyzer &);
+
+private:
+    const PcmFormat m_format;
+    std::vector<Lane> m_lanes; // From the lowest notes
+};
+
+#endif // CHROMATICANALYZER_H
@@ -5,8 +5,6 @@
 #ifndef CONSTANTS_H
 #define CONSTANTS_H
 
-#include <QtCore/qglobal.h>
-
 #define M_MAX_AMPLITUDE_8BIT_SIGNED 127
 #define M_MAX_AMPLITUDE_8BIT_UNSIGNED 255
 #define M_MAX_AMPLITUDE_16BIT_SIGNED 32767
@@ -23,12 +21,4 @@ const int DataFrequencyHzInput(48000);
 const int MaxInputValue(50);
 const int MinInputValue(-50);
 
-// Frequencies of different strings
-const qreal FrequencyE(82.407);
-const qreal FrequencyA(110.00);
-const qreal FrequencyD(146.83);
-const qreal FrequencyG(196.00);
-const qreal FrequencyB(246.94);
-const qreal Frequencye(329.63);
-
 #endif // CONSTANTS_H
@@ -0,0 +1,59 @@
+# Copyright (c) 2012 Nokia Corporation.
+#
+# Signal processing core of the guitar tuner. Plain C++, no Qt dependencies.
+
+CONFIG += c++11
+
+# Lets the compiler vectorize the sample conversion loops, which clamp with
+# float comparisons. The core does not use floating point traps.
+*-g++*|*-clang*: QMAKE_CXXFLAGS += -ftree-vectorize -fno-trapping-math
+
+# Calculates the FFT and the peak search in fixed point, for the targets
+# without a floating point unit: qmake CONFIG+=fixed_point
+fixed_point: DEFINES += DSPCORE_FIXED_POINT
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+HEADERS += \
+    $$PWD/analysisplan.h \
+    $$PWD/chromaticanalyzer.h \
+    $$PWD/constants.h \
+    $$PWD/fastfouriertransformer.h \
+    $$PWD/fixedfouriertransformer.h \
+    $$PWD/noisefloorestimator.h \
+    $$PWD/onsetdetector.h \
+    $$PWD/pcmformat.h \
+    $$PWD/pcmwriter.h \
+    $$PWD/pitchanalyzer.h \
+    $$PWD/pitchtracker.h \
+    $$PWD/pluckedstring.h \
+    $$PWD/powergovernor.h \
+    $$PWD/spectrumbuffer.h \
+    $$PWD/tonecache.h \
+    $$PWD/tonegenerator.h \
+    $$PWD/tuning.h \
+    $$PWD/wavetable.h
+
+SOURCES += \
+    $$PWD/analysisplan.cpp \
+    $$PWD/chromaticanalyzer.cpp \
+    $$PWD/fastfouriertransformer.cpp \
+    $$PWD/fixedfouriertransformer.cpp \
+    $$PWD/noisefloorestimator.cpp \
+    $$PWD/onsetdetector.cpp \
+    $$PWD/pcmformat.cpp \
+    $$PWD/pcmwriter.cpp \
+    $$PWD/pitchanalyzer.cpp \
+    $$PWD/pitchtracker.cpp \
+    $$PWD/pluckedstring.cpp \
+    $$PWD/powergovernor.cpp \
+    $$PWD/spectrumbuffer.cpp \
+    $$PWD/tonecache.cpp \
+    $$PWD/tonegenerator.cpp \
+    $$PWD/tuning.cpp \
+    $$PWD/wavetable.cpp
+
+# Compiled as a part of fastfouriertransformer.cpp.
+OTHER_FILES += \
+    $$PWD/fftpack.c
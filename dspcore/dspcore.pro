@@ -0,0 +1,11 @@
+# Copyright (c) 2012 Nokia Corporation.
+#
+# Builds the signal processing core as a static library, for embedding the
+# tuner engine in applications which do not use Qt.
+
+TEMPLATE = lib
+TARGET = dspcore
+CONFIG += staticlib
+CONFIG -= qt
+
+include(dspcore.pri)
@@ -0,0 +1,382 @@
+/**
+ * Copyright (c) 2011-2012 Nokia Corporation.
+ */
+
+#include "fastfouriertransformer.h"
+
+#include <assert.h>
+#include <math.h>
+#include <vector>
+
+#define STIN  inline
+#define __STATIC
+
+#include "fftpack.c"
+
+// called by __ogg_fdrffti
+__STATIC void drfti1(int n, float *wa, int *ifac);
+void __ogg_fdrffti(int n, float *wsave, int *ifac);
+void __ogg_fdcosqi(int n, float *wsave, int *ifac);
+// called by drftf1
+STIN void dradf2(int ido,int l1,float *cc,float *ch,float *wa1);
+// called by drftf1
+STIN void dradf4(int ido,int l1,float *cc,float *ch,float *wa1,
+        float *wa2,float *wa3);
+// called by drftf1
+STIN void dradfg(int ido,int ip,int l1,int idl1,float *cc,float *c1,
+        float *c2,float *ch,float *ch2,float *wa);
+// called by drftf1
+STIN void drftf1(int n,float *c,float *ch,float *wa,int *ifac);
+void __ogg_fdrfftf(int n,float *r,float *wsave,int *ifac);
+STIN void dcsqf1(int n,float *x,float *w,float *xh,int *ifac);
+void __ogg_fdcosqf(int n,float *x,float *wsave,int *ifac);
+STIN void dradb2(int ido,int l1,float *cc,float *ch,float *wa1);
+STIN void dradb3(int ido,int l1,float *cc,float *ch,float *wa1,
+                          float *wa2);
+STIN void dradb4(int ido,int l1,float *cc,float *ch,float *wa1,
+        float *wa2,float *wa3);
+STIN void dradbg(int ido,int ip,int l1,int idl1,float *cc,float *c1,
+            float *c2,float *ch,float *ch2,float *wa);
+STIN void drftb1(int n, float *c, float *ch, float *wa, int *ifac);
+void __ogg_fdrfftb(int n, float *r, float *wsave, int *ifac);
+STIN void dcsqb1(int n,float *x,float *w,float *xh,int *ifac);
+void __ogg_fdcosqb(int n,float *x,float *wsave,int *ifac);
+
+
+/*!
+  \class FastFourierTransformer
+  \brief Calculates the FFT of PCM samples and finds the peak of the
+         spectrum.
+
+  By default the transformation is calculated in floating point with
+  fftpack. If DSPCORE_FIXED_POINT is defined, see dspcore.pri, the forward
+  transformation and the peak search run in fixed point instead, see
+  FixedFourierTransformer, for the targets without a floating point unit.
+  Only the accessors of single indexes, e.g. getPeakOffset(), convert to
+  floating point. The fixed point coefficients are within 1e-4 of the
+  largest coefficient of the frame from the exact ones, i.e. -80 dB, which
+  keeps the peak index and the interpolated peak of a tone the same as in
+  floating point, see dspcore/tests/fixedpoint.
+*/
+
+
+/*!
+  Constructor.
+*/
+FastFourierTransformer::FastFourierTransformer()
+    :
+#ifdef DSPCORE_FIXED_POINT
+      m_waveFixed(0),
+      m_exponent(0),
+#else
+      m_waveFloat(0),
+      m_workingArray(0),
+      m_ifac(0),
+#endif
+      m_last_n(-1),
+      m_cutOffForDensitySquared(0),
+      m_maximumDensitySquared(0)
+{
+}
+
+
+/*!
+  Destructor.
+*/
+FastFourierTransformer::~FastFourierTransformer()
+{
+#ifdef DSPCORE_FIXED_POINT
+    delete [] m_waveFixed;
+#else
+    if (m_waveFloat != 0) {
+        delete [] m_waveFloat;
+    }
+
+    if (m_workingArray != 0) {
+       delete [] m_workingArray;
+    }
+
+    if (m_ifac != 0) {
+        delete [] m_ifac;
+    }
+#endif
+}
+
+
+/*!
+  Prepares the arrays to be of length \a n.
+*/
+void FastFourierTransformer::reserve(int n)
+{
+    assert(n > 0);
+
+#ifdef DSPCORE_FIXED_POINT
+    delete [] m_waveFixed;
+    m_waveFixed = new int32_t[n];
+    m_fixed.reserve(n);
+#else
+    if (m_waveFloat != 0) {
+        delete [] m_waveFloat;
+    }
+
+    if (m_workingArray != 0) {
+       delete [] m_workingArray;
+    }
+
+    if (m_ifac != 0) {
+        delete [] m_ifac;
+    }
+
+    m_workingArray = new float[2 * n + 15];
+    m_waveFloat = new float[n];
+    m_ifac = new int[n];
+    __ogg_fdrffti(n, m_workingArray, m_ifac);
+#endif
+    m_last_n = n;
+}
+
+
+/*!
+  Calculates the Fast Fourier Transformation (FFT) of the \a n samples
+  pointed by \a wave.
+*/
+void FastFourierTransformer::calculateFFT(const int16_t *wave, int n)
+{
+    if (m_last_n != n) {
+        reserve(n);
+    }
+
+#ifdef DSPCORE_FIXED_POINT
+    m_exponent = m_fixed.transform(wave, n, m_waveFixed);
+#else
+    for (int i = 0; i < n; i++) {
+        m_waveFloat[i] = (float) wave[i];
+    }
+
+    __ogg_fdrfftf(n, m_waveFloat, m_workingArray, m_ifac);
+#endif
+}
+
+
+/*!
+  Calculates the inverse FFT of the \a n coefficients pointed by \a data,
+  in place. The coefficients are in the order calculateFFT() leaves them,
+  and the result is not normalized: transforming forward and back scales
+  the data by \a n.
+
+  Always calculated in floating point, as it is not on the analysis path.
+*/
+void FastFourierTransformer::calculateInverseFFT(float *data, int n)
+{
+#ifdef DSPCORE_FIXED_POINT
+    std::vector<float> workingArray(2 * n + 15);
+    std::vector<int> ifac(n);
+    __ogg_fdrffti(n, &workingArray[0], &ifac[0]);
+    __ogg_fdrfftb(n, data, &workingArray[0], &ifac[0]);
+#else
+    if (m_last_n != n) {
+        reserve(n);
+    }
+
+    __ogg_fdrfftb(n, data, m_workingArray, m_ifac);
+#endif
+}
+
+
+/*!
+  Returns the index which corresponds to the maximum density of the FFT.
+*/
+int FastFourierTransformer::getMaximumDensityIndex()
+{
+    return getMaximumDensityIndex(1, m_last_n / 2 - 1);
+}
+
+
+/*!
+  Returns the index which corresponds to the maximum density of the FFT
+  among the indices from \a first to \a last.
+*/
+int FastFourierTransformer::getMaximumDensityIndex(int first, int last)
+{
+    assert(first >= 1 && last < (m_last_n + 1) / 2);
+
+#ifdef DSPCORE_FIXED_POINT
+    // The coefficients are below 2^31, so the squared densities fit into
+    // 64 bits.
+    int64_t maxDensityFixed = 0;
+    int maxDensityIndex = 0;
+
+    for (int k = first; k <= last; k++) {
+        const int64_t cosCoefficient = m_waveFixed[2 * k - 1];
+        const int64_t sinCoefficient = m_waveFixed[2 * k];
+        const int64_t densitySquared =
+            sinCoefficient * sinCoefficient + cosCoefficient * cosCoefficient;
+
+        if (densitySquared > maxDensityFixed) {
+            maxDensityFixed = densitySquared;
+            maxDensityIndex = k;
+        }
+    }
+
+    const float maxDensity = ldexpf((float)maxDensityFixed, 2 * m_exponent);
+#else
+    float maxDensity = 0;
+    int maxDensityIndex = 0;
+    float densitySquared = 0.f;
+
+    for (int k = first; k <= last; k++) {
+        // Here, we calculate the frequency k/N.
+        // k=1, the wave oscillation time is N, and the frequency
+        //      is 1/sample.
+        // k=2, the wave oscillation time is N/2, and the frequency
+        //      is 2/sample.
+        // k=3, the wave oscillation time is N/3, and the frequency
+        //      is 3/sample.
+        // Note, that the documentation is for Fortran, so indexes in the
+        // documentation does not match.
+        // The sine and cosine coefficients are obtained thus as follows:
+        const float cosCoefficient = fabsf(m_waveFloat[2 * k - 1]);
+        const float sinCoefficient = fabsf(m_waveFloat[2 * k]);
+
+        densitySquared =
+            sinCoefficient * sinCoefficient + cosCoefficient * cosCoefficient;
+
+        if (densitySquared > maxDensity) {
+            maxDensity = densitySquared;
+            maxDensityIndex = k;
+        }
+    }
+#endif
+
+    m_maximumDensitySquared = maxDensity;
+
+    if (m_cutOffForDensitySquared < maxDensity) {
+        return maxDensityIndex;
+    }
+
+    return -1;
+}
+
+
+/*!
+  Returns the squared density of the highest peak found by the latest
+  getMaximumDensityIndex(), regardless of the cutoff.
+*/
+float FastFourierTransformer::getMaximumDensitySquared() const
+{
+    return m_maximumDensitySquared;
+}
+
+
+/*!
+  Stores the squared densities of the indexes from \a first to \a last of
+  the last calculated FFT to \a densities.
+*/
+void FastFourierTransformer::getDensitiesSquared(float *densities, int first,
+                                                 int last) const
+{
+    assert(first >= 1 && last < (m_last_n + 1) / 2);
+
+    for (int k = first; k <= last; k++) {
+        const float cosCoefficient = coefficient(2 * k - 1);
+        const float sinCoefficient = coefficient(2 * k);
+        densities[k - first] =
+            sinCoefficient * sinCoefficient + cosCoefficient * cosCoefficient;
+    }
+}
+
+
+/*!
+  Returns the offset, between -0.5 and 0.5 bins, of the true peak from the
+  peak at \a index. Uses the complex coefficients of \a index and its
+  neighbours (Jacobsen's estimator with the correction of Candan), which,
+  unlike a parabola fitted to the densities, is not biased for the
+  rectangular window of the frames.
+*/
+float FastFourierTransformer::getPeakOffset(int index) const
+{
+    const int halfN = m_last_n / 2;
+
+    if (index < 2 || index >= halfN - 1) {
+        return 0;
+    }
+
+    float w[6];
+
+    for (int i = 0; i < 6; i++) {
+        w[i] = coefficient(2 * index - 3 + i);
+    }
+
+    // (X[k - 1] - X[k + 1]) / (2 X[k] - X[k - 1] - X[k + 1])
+    const float numeratorRe = w[0] - w[4];
+    const float numeratorIm = w[1] - w[5];
+    const float denominatorRe = 2 * w[2] - w[0] - w[4];
+    const float denominatorIm = 2 * w[3] - w[1] - w[5];
+    const float magnitude = denominatorRe * denominatorRe
+            + denominatorIm * denominatorIm;
+
+    if (magnitude <= 0) {
+        return 0;
+    }
+
+    const float ratio = (numeratorRe * denominatorRe
+                         + numeratorIm * denominatorIm) / magnitude;
+    const float binAngle = float(M_PI) / m_last_n;
+    const float offset = atanf(tanf(binAngle) * ratio) / binAngle;
+    return offset < -0.5f ? -0.5f : (offset > 0.5f ? 0.5f : offset);
+}
+
+
+/*!
+  Returns the phase, in radians between -pi and pi, of the index \a index of
+  the last calculated FFT, relative to the first sample of the wave.
+*/
+float FastFourierTransformer::getPhase(int index) const
+{
+    assert(index >= 1 && index < (m_last_n + 1) / 2);
+
+    return atan2f(coefficient(2 * index), coefficient(2 * index - 1));
+}
+
+
+/*!
+  Returns the smallest length of at least \a n whose only prime factors are
+  2, 3 and 5, for which the transformation is the fastest.
+*/
+int FastFourierTransformer::optimalSize(int n)
+{
+    for (;; n++) {
+        int m = n;
+
+        while (m % 2 == 0) m /= 2;
+        while (m % 3 == 0) m /= 3;
+        while (m % 5 == 0) m /= 5;
+
+        if (m == 1) {
+            return n;
+        }
+    }
+}
+
+
+/*!
+  Returns the coefficient at \a i, in the order of fftpack, of the last
+  calculated FFT.
+*/
+inline float FastFourierTransformer::coefficient(int i) const
+{
+#ifdef DSPCORE_FIXED_POINT
+    return ldexpf((float)m_waveFixed[i], m_exponent);
+#else
+    return m_waveFloat[i];
+#endif
+}
+
+
+/*!
+  Sets the cutoff density.
+*/
+void FastFourierTransformer::setCutOffForDensity(float cutoff)
+{
+    m_cutOffForDensitySquared = cutoff * cutoff;
+}
@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2011-2012 Nokia Corporation.
+ */
+
+#ifndef FASTFOURIERTRANSFORM_H
+#define FASTFOURIERTRANSFORM_H
+
+#include <stdint.h>
+
+#ifdef DSPCORE_FIXED_POINT
+#include "fixedfouriertransformer.h"
+#endif
+
+class FastFourierTransformer
+{
+public:
+    FastFourierTransformer();
+    ~FastFourierTransformer();
+
+public:
+    void reserve(int n);
+    void calculateFFT(const int16_t *wave, int n);
+    void calculateInverseFFT(float *data, int n);
+    int getMaximumDensityIndex();
+    int getMaximumDensityIndex(int first, int last);
+    float getMaximumDensitySquared() const;
+    void getDensitiesSquared(float *densities, int first, int last) const;
+    float getPeakOffset(int index) const;
+    float getPhase(int index) const;
+    void setCutOffForDensity(float cutoff);
+
+    static int optimalSize(int n);
+
+private:
+    float coefficient(int i) const;
+
+private:
+    // Not copyable
+    FastFourierTransformer(const FastFourierTransformer &);
+    FastFourierTransformer &operator=(const FastFourierTransformer &);
+
+private:
+#ifdef DSPCORE_FIXED_POINT
+    FixedFourierTransformer m_fixed;
+    int32_t *m_waveFixed;
+    int m_exponent; // Of the coefficients in m_waveFixed
+#else
+    float *m_waveFloat;
+    float *m_workingArray;
+    int *m_ifac;
+#endif
+    int m_last_n;
+    float m_cutOffForDensitySquared;
+    float m_maximumDensitySquared;
+};
+
+#endif // FASTFOURIERTRANSFORM_H
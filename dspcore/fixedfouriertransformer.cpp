@@ -0,0 +1,351 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "fixedfouriertransformer.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+
+// The twiddle factors are in Q15, i.e. scaled by 2^15. They are stored in
+// 32 bits, so that 1 is exact and the butterflies have no gain error.
+const static int TwiddleBits(15);
+const static double TwiddleScale(32768.0);
+
+// The input is scaled up so that the coefficients use the whole Q31 range:
+// as long as the largest sample times twice the length stays below 2^31, no
+// stage can overflow. Samples are Q15, so at most 16 bits are added.
+const static int MaximumInputShift(16);
+
+
+/*!
+  \class FixedFourierTransformer
+  \brief Calculates the FFT of real PCM samples in fixed point arithmetic.
+
+  The fixed point variant of the transformation of FastFourierTransformer,
+  for the targets without a floating point unit. The samples, which are Q15,
+  are scaled to Q31 with a block exponent chosen for each frame, so that
+  quiet frames keep their precision and loud ones do not overflow. The
+  twiddle factors are Q15, and the products are accumulated in 64 bits and
+  rounded once per butterfly.
+
+  The transformation of N real samples is calculated as a complex
+  transformation of N / 2 points, holding the even samples in the real and
+  the odd samples in the imaginary parts, and split into the spectrum of the
+  real samples in the end. Odd lengths are transformed as complex with zero
+  imaginary parts. The complex transformation is a self-sorting mixed radix
+  one (Stockham), with butterflies of radix 4 and 2 and a plain DFT for the
+  other prime factors, like the one of fftpack. The lengths of
+  FastFourierTransformer::optimalSize() have only the factors 3 and 5
+  besides 2.
+
+  Floating point is only used by reserve(), to compute the twiddle factors.
+*/
+
+
+/*!
+  Constructor.
+*/
+FixedFourierTransformer::FixedFourierTransformer()
+    : m_n(0)
+{
+}
+
+
+/*!
+  Prepares the twiddle factors and the buffers for the length \a n.
+*/
+void FixedFourierTransformer::reserve(int n)
+{
+    assert(n > 0);
+
+    const int length = (n % 2 == 0) ? n / 2 : n;
+
+    m_cos.resize(n);
+    m_sin.resize(n);
+
+    for (int t = 0; t < n; ++t) {
+        const double angle = 2 * M_PI * t / n;
+        m_cos[t] = int32_t(floor(TwiddleScale * cos(angle) + 0.5));
+        m_sin[t] = int32_t(floor(-TwiddleScale * sin(angle) + 0.5));
+    }
+
+    m_factors.clear();
+    int remaining = length;
+
+    while (remaining % 4 == 0) {
+        m_factors.push_back(4);
+        remaining /= 4;
+    }
+
+    if (remaining % 2 == 0) {
+        m_factors.push_back(2);
+        remaining /= 2;
+    }
+
+    int radix = 4;
+
+    for (int p = 3; remaining > 1; p += 2) {
+        if (p * p > remaining) {
+            // The rest is a prime.
+            p = remaining;
+        }
+
+        while (remaining % p == 0) {
+            m_factors.push_back(p);
+            remaining /= p;
+            radix = std::max(radix, p);
+        }
+    }
+
+    m_data.resize(length);
+    m_work.resize(length);
+    m_butterfly.resize(4 * radix);
+    m_n = n;
+}
+
+
+/*!
+  Returns the length prepared by reserve(), or 0.
+*/
+int FixedFourierTransformer::size() const
+{
+    return m_n;
+}
+
+
+/*!
+  Calculates the FFT of the \a n samples pointed by \a wave to
+  \a coefficients, in the order of fftpack: the DC component, followed by
+  the cosine and sine coefficients of each index, i.e. the real and
+  imaginary parts, and for an even \a n the Nyquist component. Returns the
+  block exponent: each coefficient is its value times 2^exponent, i.e. the
+  values are the same as those of the floating point transformation.
+*/
+int FixedFourierTransformer::transform(const int16_t *wave, int n,
+                                       int32_t *coefficients)
+{
+    if (m_n != n) {
+        reserve(n);
+    }
+
+    int maximum = 0;
+
+    for (int i = 0; i < n; ++i) {
+        const int value = abs(int(wave[i]));
+
+        if (value > maximum) {
+            maximum = value;
+        }
+    }
+
+    int shift = 0;
+
+    while (shift < MaximumInputShift
+           && (int64_t(maximum) << (shift + 1)) * 2 * n < (int64_t(1) << 31)) {
+        ++shift;
+    }
+
+    const int length = (int)m_data.size();
+    Complex *data = &m_data[0];
+
+    if (n % 2 == 0) {
+        for (int j = 0; j < length; ++j) {
+            data[j].re = int32_t(wave[2 * j]) << shift;
+            data[j].im = int32_t(wave[2 * j + 1]) << shift;
+        }
+    }
+    else {
+        for (int j = 0; j < length; ++j) {
+            data[j].re = int32_t(wave[j]) << shift;
+            data[j].im = 0;
+        }
+    }
+
+    transformComplex();
+    data = &m_data[0];
+
+    if (n % 2 != 0) {
+        coefficients[0] = data[0].re;
+
+        for (int k = 1; 2 * k < n; ++k) {
+            coefficients[2 * k - 1] = data[k].re;
+            coefficients[2 * k] = data[k].im;
+        }
+
+        return -shift;
+    }
+
+    // Split the spectrum of the even and the odd samples:
+    // X[k] = (Z[k] + Z*[M - k]) / 2 - i W^k (Z[k] - Z*[M - k]) / 2
+    const int64_t round = int64_t(1) << TwiddleBits;
+
+    for (int k = 0; k <= length; ++k) {
+        const Complex &z = data[k % length];
+        const Complex &mirror = data[(length - k) % length];
+        const int64_t evenRe = int64_t(z.re) + mirror.re;
+        const int64_t evenIm = int64_t(z.im) - mirror.im;
+        const int64_t oddRe = int64_t(z.im) + mirror.im;
+        const int64_t oddIm = -(int64_t(z.re) - mirror.re);
+        const int64_t wr = m_cos[k];
+        const int64_t wi = m_sin[k];
+        const int32_t re = int32_t(((evenRe << TwiddleBits) + oddRe * wr
+                                    - oddIm * wi + round) >> (TwiddleBits + 1));
+        const int32_t im = int32_t(((evenIm << TwiddleBits) + oddRe * wi
+                                    + oddIm * wr + round) >> (TwiddleBits + 1));
+
+        if (k == 0) {
+            coefficients[0] = re;
+        }
+        else if (k == length) {
+            coefficients[n - 1] = re;
+        }
+        else {
+            coefficients[2 * k - 1] = re;
+            coefficients[2 * k] = im;
+        }
+    }
+
+    return -shift;
+}
+
+
+/*!
+  Calculates the complex FFT of m_data in place, using m_work.
+
+  Each stage of radix p splits the transformations of the current length
+  into p interleaved ones of a p:th of the length, and the stride of the
+  interleaving grows by p, so that the result is in the natural order.
+*/
+void FixedFourierTransformer::transformComplex()
+{
+    const int64_t round = int64_t(1) << (TwiddleBits - 1);
+    Complex *x = &m_data[0];
+    Complex *y = &m_work[0];
+    int length = (int)m_data.size();
+    int stride = 1;
+    const int radix = (int)m_butterfly.size() / 4;
+    Complex *in = &m_butterfly[0];
+    Complex *b = in + radix;
+    Complex *roots = b + radix; // W^t of the butterfly
+    Complex *w = roots + radix; // W^(q * k) of the stage
+
+    for (size_t f = 0; f < m_factors.size(); ++f) {
+        const int p = m_factors[f];
+        const int m = length / p;
+
+        for (int t = 0; t < p; ++t) {
+            roots[t] = twiddle(t, p);
+        }
+
+        for (int q = 0; q < m; ++q) {
+            for (int k = 1; k < p; ++k) {
+                w[k] = twiddle(q * k, length);
+            }
+
+            for (int r = 0; r < stride; ++r) {
+                for (int j = 0; j < p; ++j) {
+                    in[j] = x[r + stride * (q + m * j)];
+                }
+
+                Complex *out = y + r + stride * p * q;
+
+                if (p == 4) {
+                    const int32_t t0re = in[0].re + in[2].re;
+                    const int32_t t0im = in[0].im + in[2].im;
+                    const int32_t t1re = in[0].re - in[2].re;
+                    const int32_t t1im = in[0].im - in[2].im;
+                    const int32_t t2re = in[1].re + in[3].re;
+                    const int32_t t2im = in[1].im + in[3].im;
+                    const int32_t t3re = in[1].re - in[3].re;
+                    const int32_t t3im = in[1].im - in[3].im;
+                    in[0].re = t0re + t2re;
+                    in[0].im = t0im + t2im;
+                    in[1].re = t1re + t3im;
+                    in[1].im = t1im - t3re;
+                    in[2].re = t0re - t2re;
+                    in[2].im = t0im - t2im;
+                    in[3].re = t1re - t3im;
+                    in[3].im = t1im + t3re;
+                }
+                else if (p == 2) {
+                    const Complex sum = { in[0].re + in[1].re,
+                                          in[0].im + in[1].im };
+                    in[1].re = in[0].re - in[1].re;
+                    in[1].im = in[0].im - in[1].im;
+                    in[0] = sum;
+                }
+                else {
+                    // A DFT of p points.
+                    for (int k = 0; k < p; ++k) {
+                        int64_t re = int64_t(in[0].re) << TwiddleBits;
+                        int64_t im = int64_t(in[0].im) << TwiddleBits;
+                        int t = 0;
+
+                        for (int j = 1; j < p; ++j) {
+                            // t = j * k modulo p
+                            t += k;
+
+                            if (t >= p) {
+                                t -= p;
+                            }
+
+                            re += int64_t(in[j].re) * roots[t].re
+                                    - int64_t(in[j].im) * roots[t].im;
+                            im += int64_t(in[j].re) * roots[t].im
+                                    + int64_t(in[j].im) * roots[t].re;
+                        }
+
+                        b[k].re = int32_t((re + round) >> TwiddleBits);
+                        b[k].im = int32_t((im + round) >> TwiddleBits);
+                    }
+
+                    for (int k = 0; k < p; ++k) {
+                        in[k] = b[k];
+                    }
+                }
+
+                out[0] = in[0];
+
+                for (int k = 1; k < p; ++k) {
+                    if (q == 0) {
+                        out[stride * k] = in[k];
+                        continue;
+                    }
+
+                    out[stride * k].re = int32_t((int64_t(in[k].re) * w[k].re
+                                                  - int64_t(in[k].im) * w[k].im
+                                                  + round) >> TwiddleBits);
+                    out[stride * k].im = int32_t((int64_t(in[k].re) * w[k].im
+                                                  + int64_t(in[k].im) * w[k].re
+                                                  + round) >> TwiddleBits);
+                }
+            }
+        }
+
+        length = m;
+        stride *= p;
+        Complex *swap = x;
+        x = y;
+        y = swap;
+    }
+
+    if (x != &m_data[0]) {
+        m_data.swap(m_work);
+    }
+}
+
+
+/*!
+  Returns W^exponent of the transformation of \a length points, a divisor
+  of the length prepared by reserve(), in Q15.
+*/
+FixedFourierTransformer::Complex FixedFourierTransformer::twiddle(
+        int exponent, int length) const
+{
+    const int index = exponent * (m_n / length);
+    const Complex w = { m_cos[index], m_sin[index] };
+    return w;
+}
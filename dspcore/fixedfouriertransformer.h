@@ -0,0 +1,48 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef FIXEDFOURIERTRANSFORMER_H
+#define FIXEDFOURIERTRANSFORMER_H
+
+#include <stdint.h>
+#include <vector>
+
+
+class FixedFourierTransformer
+{
+public:
+    FixedFourierTransformer();
+
+public:
+    void reserve(int n);
+    int size() const;
+    int transform(const int16_t *wave, int n, int32_t *coefficients);
+
+private:
+    struct Complex
+    {
+        int32_t re;
+        int32_t im;
+    };
+
+private:
+    void transformComplex();
+    Complex twiddle(int exponent, int length) const;
+
+private:
+    // Not copyable
+    FixedFourierTransformer(const FixedFourierTransformer &);
+    FixedFourierTransformer &operator=(const FixedFourierTransformer &);
+
+private:
+    std::vector<int32_t> m_cos; // Q15 cosines of the N roots of unity
+    std::vector<int32_t> m_sin; // Q15 negated sines of the roots
+    std::vector<int> m_factors; // Radixes of the complex transform
+    std::vector<Complex> m_data;
+    std::vector<Complex> m_work;
+    std::vector<Complex> m_butterfly; // Scratch of the butterflies
+    int m_n;
+};
+
+#endif // FIXEDFOURIERTRANSFORMER_H
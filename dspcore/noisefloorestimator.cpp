@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "noisefloorestimator.h"
+
+#include <math.h>
+
+// How fast the floor follows the level down, as a share of the difference
+// per frame.
+const static double FallSmoothing(0.5);
+
+// How fast the floor may rise towards a louder noise level.
+const static double RiseDecibelsPerSecond(1.0);
+
+// Keeps the floor from sticking to zero in digital silence.
+const static double MinimumFloor(1e-3);
+
+
+/*!
+  \class NoiseFloorEstimator
+  \brief Tracks the level of the background noise.
+
+  A minimum tracker on the mean energy of the analyzed frames: the floor
+  follows quieter frames quickly and rises only slowly towards louder ones.
+  Frames which have a clear spectral peak may only lower the floor, so that a
+  sustained note does not become a part of it. Each update is O(1).
+*/
+
+
+/*!
+  Constructor.
+*/
+NoiseFloorEstimator::NoiseFloorEstimator()
+    : m_floor(MinimumFloor),
+      m_isTracking(false)
+{
+}
+
+
+/*!
+  Forgets the tracked floor. The next update sets the floor directly.
+*/
+void NoiseFloorEstimator::reset()
+{
+    m_floor = MinimumFloor;
+    m_isTracking = false;
+}
+
+
+/*!
+  Updates the floor with a frame of mean energy \a energy (mean of the squared
+  samples) spanning \a duration seconds. \a isTonal tells whether the
+  spectrum of the frame has a clear peak.
+*/
+void NoiseFloorEstimator::update(double energy, double duration, bool isTonal)
+{
+    if (energy < MinimumFloor) {
+        energy = MinimumFloor;
+    }
+
+    if (!m_isTracking) {
+        if (!isTonal) {
+            m_floor = energy;
+            m_isTracking = true;
+        }
+    }
+    else if (energy < m_floor) {
+        m_floor += FallSmoothing * (energy - m_floor);
+    }
+    else if (!isTonal) {
+        const double risen = m_floor
+                * pow(10.0, RiseDecibelsPerSecond * duration / 10);
+        m_floor = risen < energy ? risen : energy;
+    }
+}
+
+
+/*!
+  Returns true if the floor has been updated since the last reset.
+*/
+bool NoiseFloorEstimator::isTracking() const
+{
+    return m_isTracking;
+}
+
+
+/*!
+  Returns the floor as mean energy per sample.
+*/
+double NoiseFloorEstimator::floor() const
+{
+    return m_floor;
+}
@@ -0,0 +1,25 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef NOISEFLOORESTIMATOR_H
+#define NOISEFLOORESTIMATOR_H
+
+
+class NoiseFloorEstimator
+{
+public:
+    NoiseFloorEstimator();
+
+public:
+    void reset();
+    void update(double energy, double duration, bool isTonal);
+    bool isTracking() const;
+    double floor() const;
+
+private:
+    double m_floor;
+    bool m_isTracking;
+};
+
+#endif // NOISEFLOORESTIMATOR_H
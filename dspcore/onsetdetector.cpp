@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "onsetdetector.h"
+
+#include <math.h>
+
+// Time constants of the short and long term energy envelopes.
+const static double FastMilliseconds(5.0);
+const static double SlowMilliseconds(100.0);
+
+// An onset is an increase of the short term energy by this factor over the
+// long term energy.
+const static float OnsetEnergyRatio(4.0f);
+
+// Minimum time between two onsets.
+const static double HoldOffMilliseconds(150.0);
+
+
+/*!
+  \class OnsetDetector
+  \brief Detects the attack of a plucked string, sample by sample.
+
+  Follows the energy flux of the signal: an onset is detected when the
+  short term energy envelope rises clearly above the long term one and above
+  a threshold. Costs a few multiplications per sample.
+*/
+
+
+/*!
+  Constructor.
+*/
+OnsetDetector::OnsetDetector()
+    : m_fastEnvelope(0),
+      m_slowEnvelope(0),
+      m_fastCoefficient(1),
+      m_slowCoefficient(1),
+      m_ratio(OnsetEnergyRatio),
+      m_threshold(0),
+      m_holdOff(0),
+      m_holdOffSamples(0)
+{
+}
+
+
+/*!
+  Returns the coefficients of the envelopes and the hold-off for samples at
+  \a sampleRate, to be given to setRates() later without recomputing them.
+*/
+OnsetDetector::Rates OnsetDetector::ratesForSampleRate(double sampleRate)
+{
+    Rates retval;
+    retval.fastCoefficient = 1 - exp(-1000.0 / (FastMilliseconds * sampleRate));
+    retval.slowCoefficient = 1 - exp(-1000.0 / (SlowMilliseconds * sampleRate));
+    retval.holdOffSamples = (int)ceil(HoldOffMilliseconds * sampleRate / 1000);
+    return retval;
+}
+
+
+/*!
+  Sets the coefficients of the envelopes and the hold-off to \a rates.
+*/
+void OnsetDetector::setRates(const Rates &rates)
+{
+    m_fastCoefficient = rates.fastCoefficient;
+    m_slowCoefficient = rates.slowCoefficient;
+    m_holdOffSamples = rates.holdOffSamples;
+}
+
+
+/*!
+  Sets the rate of the samples given to process() to \a sampleRate.
+*/
+void OnsetDetector::setSampleRate(double sampleRate)
+{
+    setRates(ratesForSampleRate(sampleRate));
+}
+
+
+/*!
+  Sets the minimum short term energy, mean of the squared samples, of an
+  onset to \a energy.
+*/
+void OnsetDetector::setThreshold(double energy)
+{
+    m_threshold = energy;
+}
+
+
+/*!
+  Forgets the envelopes.
+*/
+void OnsetDetector::reset()
+{
+    m_fastEnvelope = 0;
+    m_slowEnvelope = 0;
+    m_holdOff = 0;
+}
@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef ONSETDETECTOR_H
+#define ONSETDETECTOR_H
+
+#include <stdint.h>
+
+
+class OnsetDetector
+{
+public:
+    struct Rates
+    {
+        float fastCoefficient;
+        float slowCoefficient;
+        int holdOffSamples;
+    };
+
+public:
+    OnsetDetector();
+
+public:
+    static Rates ratesForSampleRate(double sampleRate);
+    void setRates(const Rates &rates);
+    void setSampleRate(double sampleRate);
+    void setThreshold(double energy);
+    void reset();
+
+    /*!
+      Updates the detector with \a sample. Returns true if an onset begins at
+      the sample.
+    */
+    inline bool process(int16_t sample)
+    {
+        const float energy = float(sample) * sample;
+        m_fastEnvelope += m_fastCoefficient * (energy - m_fastEnvelope);
+        m_slowEnvelope += m_slowCoefficient * (energy - m_slowEnvelope);
+
+        if (m_holdOff > 0) {
+            --m_holdOff;
+            return false;
+        }
+
+        if (m_fastEnvelope > m_threshold
+                && m_fastEnvelope > m_ratio * m_slowEnvelope) {
+            m_holdOff = m_holdOffSamples;
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    float m_fastEnvelope;
+    float m_slowEnvelope;
+    float m_fastCoefficient;
+    float m_slowCoefficient;
+    float m_ratio;
+    float m_threshold;
+    int m_holdOff;
+    int m_holdOffSamples;
+};
+
+#endif // ONSETDETECTOR_H
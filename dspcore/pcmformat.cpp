@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "pcmformat.h"
+
+#include "constants.h"
+
+
+/*!
+  \class PcmFormat
+  \brief Describes the layout of interleaved PCM data.
+
+  Mirrors the parts of QAudioFormat the DSP core needs, so that the core can
+  be used without Qt.
+*/
+
+
+/*!
+  Constructor. Creates an invalid format.
+*/
+PcmFormat::PcmFormat()
+    : sampleRate(0),
+      channels(0),
+      sampleSize(0),
+      sampleType(Unknown),
+      byteOrder(LittleEndian)
+{
+}
+
+
+/*!
+  Returns true if the format describes byte aligned samples.
+*/
+bool PcmFormat::isValid() const
+{
+    return sampleRate > 0 && channels > 0
+            && sampleSize > 0 && sampleSize % 8 == 0
+            && sampleType != Unknown;
+}
+
+
+/*!
+  Returns the number of bytes of one sample of one channel.
+*/
+int PcmFormat::bytesPerSample() const
+{
+    return sampleSize / 8;
+}
+
+
+/*!
+  Returns the number of bytes of one sample of all the channels.
+*/
+int PcmFormat::bytesPerFrame() const
+{
+    return channels * bytesPerSample();
+}
+
+
+/*!
+  Interprets \a ptr as a pointer to a sample in \a format and returns it as a
+  signed 16-bit value.
+*/
+int16_t pcmReadInt16(const PcmFormat &format, const unsigned char *ptr)
+{
+    int16_t realValue(0);
+
+    if (format.sampleSize == 8) {
+        if (format.sampleType == PcmFormat::UnSignedInt) {
+            realValue = int16_t(*ptr) - M_MAX_AMPLITUDE_8BIT_SIGNED - 1;
+        }
+        else if (format.sampleType == PcmFormat::SignedInt) {
+            realValue = *reinterpret_cast<const int8_t *>(ptr);
+        }
+    }
+    else if (format.sampleSize == 16) {
+        uint16_t value(0);
+
+        if (format.byteOrder == PcmFormat::LittleEndian)
+            value = uint16_t(ptr[0] | (ptr[1] << 8));
+        else
+            value = uint16_t((ptr[0] << 8) | ptr[1]);
+
+        if (format.sampleType == PcmFormat::UnSignedInt) {
+            realValue = int16_t(value - M_MAX_AMPLITUDE_16BIT_SIGNED);
+        }
+        else if (format.sampleType == PcmFormat::SignedInt) {
+            realValue = int16_t(value);
+        }
+    }
+
+    return realValue;
+}
@@ -0,0 +1,40 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef PCMFORMAT_H
+#define PCMFORMAT_H
+
+#include <stdint.h>
+
+
+struct PcmFormat
+{
+    enum SampleType {
+        Unknown = 0,
+        SignedInt,
+        UnSignedInt,
+        Float
+    };
+
+    enum Endian {
+        BigEndian = 0,
+        LittleEndian
+    };
+
+    PcmFormat();
+
+    bool isValid() const;
+    int bytesPerSample() const;
+    int bytesPerFrame() const;
+
+    int sampleRate;
+    int channels;
+    int sampleSize;
+    SampleType sampleType;
+    Endian byteOrder;
+};
+
+int16_t pcmReadInt16(const PcmFormat &format, const unsigned char *ptr);
+
+#endif // PCMFORMAT_H
@@ -0,0 +1,191 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "pcmwriter.h"
+
+#include <math.h>
+#include <string.h>
+
+
+namespace {
+
+/*!
+  Stores the \a Bytes lowest bytes of \a value to \a ptr in the byte order.
+*/
+template <int Bytes, bool BigEndian>
+inline void store(unsigned char *ptr, uint32_t value)
+{
+    for (int i = 0; i < Bytes; ++i) {
+        ptr[BigEndian ? Bytes - 1 - i : i] = uint8_t(value >> (8 * i));
+    }
+}
+
+
+/*!
+  Converts \a count values between -1 and 1 to integer samples of \a Bits
+  bits. The values out of the range saturate to the largest sample, and the
+  rest are rounded to the nearest. Unsigned samples are the signed ones
+  offset by half of the range.
+
+  The loop has no branches or dependencies between the samples, so that the
+  compiler vectorizes it.
+*/
+template <int Bits, bool Unsigned, bool BigEndian>
+void writeInt(unsigned char *data, const float *values, int count)
+{
+    // The largest 32-bit sample is not representable as a float, so the
+    // largest float below it is used.
+    const float maximum = Bits == 32 ? 2147483520.0f
+                                     : float((1u << (Bits - 1)) - 1);
+    const float minimum = -float(1u << (Bits - 1));
+    const uint32_t offset = Unsigned ? 1u << (Bits - 1) : 0;
+
+    for (int i = 0; i < count; ++i) {
+        float value = values[i] * maximum;
+        value = value < minimum ? minimum : value;
+        value = value > maximum ? maximum : value;
+        const int32_t sample = int32_t(value + copysignf(0.5f, value));
+        store<Bits / 8, BigEndian>(data + i * (Bits / 8),
+                                   uint32_t(sample) + offset);
+    }
+}
+
+
+/*!
+  Stores \a count values as 32-bit floats. The values are not clamped.
+*/
+template <bool BigEndian>
+void writeFloat(unsigned char *data, const float *values, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        uint32_t bits;
+        memcpy(&bits, values + i, sizeof(bits));
+        store<4, BigEndian>(data + 4 * i, bits);
+    }
+}
+
+
+/*!
+  Returns the kernel writing samples of \a Bits bits in \a format.
+*/
+template <int Bits>
+PcmWriter::Kernel intKernel(const PcmFormat &format)
+{
+    const bool big = format.byteOrder == PcmFormat::BigEndian;
+
+    if (format.sampleType == PcmFormat::UnSignedInt) {
+        return big ? writeInt<Bits, true, true> : writeInt<Bits, true, false>;
+    }
+
+    return big ? writeInt<Bits, false, true> : writeInt<Bits, false, false>;
+}
+
+
+/*!
+  Returns the kernel writing samples in \a format, or null if there is none.
+*/
+PcmWriter::Kernel selectKernel(const PcmFormat &format)
+{
+    if (format.sampleType == PcmFormat::Float) {
+        if (format.sampleSize != 32) {
+            return 0;
+        }
+
+        return format.byteOrder == PcmFormat::BigEndian
+                ? writeFloat<true> : writeFloat<false>;
+    }
+
+    if (format.sampleType != PcmFormat::SignedInt
+            && format.sampleType != PcmFormat::UnSignedInt) {
+        return 0;
+    }
+
+    switch (format.sampleSize) {
+    case 8: return intKernel<8>(format);
+    case 16: return intKernel<16>(format);
+    case 24: return intKernel<24>(format);
+    case 32: return intKernel<32>(format);
+    default: return 0;
+    }
+}
+
+} // namespace
+
+
+/*!
+  \class PcmWriter
+  \brief Converts float samples to interleaved PCM data.
+
+  The conversion is done with a kernel selected once for the format when
+  the writer is made, so that writing does not check the sample size, type
+  or byte order per sample. There are kernels for signed and unsigned 8, 16,
+  24 and 32-bit integers in both byte orders, and for 32-bit floats.
+*/
+
+
+/*!
+  Constructor. Selects the kernel for \a format.
+*/
+PcmWriter::PcmWriter(const PcmFormat &format)
+    : m_format(format),
+      m_kernel(selectKernel(format))
+{
+}
+
+
+/*!
+  Returns the format of the data written.
+*/
+const PcmFormat &PcmWriter::format() const
+{
+    return m_format;
+}
+
+
+/*!
+  Returns true if the format can be written. Otherwise write() produces
+  silence.
+*/
+bool PcmWriter::isSupported() const
+{
+    return m_kernel != 0;
+}
+
+
+/*!
+  Writes \a sampleCount samples of \a samples to \a data, copying each
+  sample to all the channels. The \a data must have room for
+  \a sampleCount frames.
+*/
+void PcmWriter::write(unsigned char *data,
+                      const float *samples,
+                      int sampleCount) const
+{
+    const int frameBytes = m_format.bytesPerFrame();
+
+    if (!m_kernel) {
+        memset(data, 0, size_t(sampleCount) * frameBytes);
+        return;
+    }
+
+    m_kernel(data, samples, sampleCount);
+
+    if (m_format.channels == 1) {
+        return;
+    }
+
+    // The samples were converted to the beginning of the data. They are
+    // spread to the frames starting from the last one, so that no sample is
+    // overwritten before it is copied.
+    const int sampleBytes = m_format.bytesPerSample();
+
+    for (int i = sampleCount - 1; i >= 0; --i) {
+        const unsigned char *source = data + i * sampleBytes;
+        unsigned char *frame = data + i * frameBytes;
+
+        for (int j = m_format.channels - 1; j >= 0; --j) {
+            memmove(frame + j * sampleBytes, source, sampleBytes);
+        }
+    }
+}
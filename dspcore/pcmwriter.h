@@ -0,0 +1,32 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef PCMWRITER_H
+#define PCMWRITER_H
+
+#include "pcmformat.h"
+
+
+class PcmWriter
+{
+public:
+    explicit PcmWriter(const PcmFormat &format);
+
+public:
+    const PcmFormat &format() const;
+    bool isSupported() const;
+    void write(unsigned char *data, const float *samples,
+               int sampleCount) const;
+
+public:
+    // Converts count values to count contiguous samples of one channel.
+    typedef void (*Kernel)(unsigned char *data, const float *values,
+                           int count);
+
+private:
+    const PcmFormat m_format;
+    Kernel m_kernel; // Selected for m_format, or null if not supported
+};
+
+#endif // PCMWRITER_H
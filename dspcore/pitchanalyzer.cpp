@@ -0,0 +1,1351 @@
+/**
+ * Copyright (c) 2011-2012 Nokia Corporation.
+ */
+
+#include "pitchanalyzer.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "constants.h"
+
+// Constant used to scale the cut-off density for the fft helper.
+const static float CutOffScaler(0.05);
+
+// Share of the sensitivity based cut-off density which is used as the
+// absolute minimum cut-off when the noise floor is low.
+const static double MinimumCutOffShare(0.25);
+
+// The range of the margin, in decibels, which the peak density needs to have
+// over the expected peak density of the noise floor. Mapped from the
+// sensitivity.
+const static double MinimumCutOffMarginDecibels(6.0);
+const static double CutOffMarginDecibelsPerPercentage(40.0);
+
+// The short term energy of an onset needs to be this many times the noise
+// floor.
+const static double OnsetFloorRatio(10.0);
+
+// A frame is considered tonal if its peak density is this many times the
+// expected peak density of white noise of the same energy.
+const static double TonalPeakRatio(8.0);
+
+// By default, force the precision to be "1/PrecisionPerNote" notes near the
+// target frequency.
+const static int PrecisionPerNote(4);
+
+// The voice difference ranges over log_2(MaximumOctaveRange) octaves to both
+// directions from the target frequency, see AnalysisPlan.
+const static int MaximumOctaveRange(4);
+
+// A reading is stable, for the power governor, when the tracker is this
+// confident and the interpolated peak is this many semitones from the
+// smoothed value.
+const static double StableConfidence(0.8);
+const static double StableDifference(0.05);
+
+// The strobe measures the phase advance of the peak between frames, which
+// gives the frequency up to multiples of 1 / hop. The hop is kept within a
+// frame, so that the multiples are at least a bin apart and the interpolated
+// peak picks the right one. The frequency is then measured over the marks of
+// the last StrobeBaseline seconds, and restarted if it drifts further than
+// MaximumStrobeDrift bins from the peak.
+const static double MaximumStrobeHop(1.0);
+const static double StrobeBaseline(1.0);
+const static double MaximumStrobeDrift(0.5);
+
+
+/*!
+  \class PitchResult
+  \brief The outcome of analyzing one frame of samples.
+*/
+
+
+/*!
+  Constructor.
+*/
+PitchResult::PitchResult()
+    : isLowVoice(true),
+      isCorrectFrequency(false),
+      voiceDifference(0),
+      frequency(0),
+      smoothedVoiceDifference(0),
+      confidence(0),
+      stringIndex(-1),
+      note(-1),
+      hasStrobe(false),
+      strobeCents(0),
+      strobeBeat(0)
+{
+}
+
+
+/*!
+  \class PitchAnalyzerStatistics
+  \brief Counters describing how much work the analyzer has done.
+*/
+
+
+/*!
+  Constructor.
+*/
+PitchAnalyzerStatistics::PitchAnalyzerStatistics()
+    : framesAnalyzed(0),
+      framesGated(0),
+      onsetsDetected(0),
+      onsetsMeasured(0),
+      lastOnsetLatency(0),
+      totalOnsetLatency(0),
+      framesSkipped(0),
+      analysisTime(0),
+      savedTime(0),
+      streamTime(0)
+{
+}
+
+
+/*!
+  Returns the share of the frames for which the FFT was skipped, a number
+  between 0 and 1.
+*/
+double PitchAnalyzerStatistics::skipRatio() const
+{
+    const int64_t total = framesAnalyzed + framesGated;
+
+    if (total == 0) {
+        return 0;
+    }
+
+    return double(framesGated) / total;
+}
+
+
+/*!
+  Returns the average time in seconds from an onset to the first reading
+  after it.
+*/
+double PitchAnalyzerStatistics::averageOnsetLatency() const
+{
+    if (onsetsMeasured == 0) {
+        return 0;
+    }
+
+    return totalOnsetLatency / onsetsMeasured;
+}
+
+
+/*!
+  Returns the estimated processing time in seconds saved by the power
+  governor per minute of audio.
+*/
+double PitchAnalyzerStatistics::savedTimePerMinute() const
+{
+    if (streamTime <= 0) {
+        return 0;
+    }
+
+    return savedTime * 60 / streamTime;
+}
+
+
+/*!
+  \class PitchAnalyzerListener
+  \brief Callback interface for receiving the results of PitchAnalyzer.
+*/
+
+
+/*!
+  \class PitchAnalyzer
+  \brief Analyzes PCM data and finds the difference between the dominant
+         frequency and the target frequency.
+
+  The analyzer has no dependencies to Qt. The results can be received either
+  via PitchAnalyzerListener, which is called synchronously from write(), or
+  by polling takeResult().
+
+  Each result carries, in addition to the measurement of the frame, the
+  voice difference smoothed over consecutive frames by PitchTracker. The
+  smoothed value stays steady with short frames, see setPrecisionPerNote().
+
+  OnsetDetector follows the decimated samples. When a string is plucked, the
+  frame is restarted at the attack, so that the first reading is not
+  delayed by samples preceding the pluck.
+
+  The strings are given by setTuning(), which computes an AnalysisPlan for
+  each string and one wide-band plan for the auto mode, covering all the
+  strings at once. Selecting a string, or enabling the auto mode, only
+  switches the plan in use. The peak index is mapped to the nearest string
+  and the voice difference from it with the table of the plan.
+
+  All the plans of a tuning decimate the samples alike, so switching the
+  plan keeps the frame being collected: the next result, measured from the
+  new target, is due when the frame would have been full anyway.
+
+  In the chromatic mode, ChromaticAnalyzer measures the difference from the
+  nearest note over the full range of the notes instead of the strings.
+
+  A frame is analyzed as soon as its last sample is written. When the
+  period in which the audio device delivers the data is known, see
+  setCapturePeriod(), the frames are scheduled to end at the end of a
+  period, so that a frame is analyzed as soon as the device delivers it.
+  Otherwise the rest of the write() after a frame is skipped.
+
+  In the strobe mode, see setStrobeModeEnabled(), consecutive frames overlap
+  by half, and the phase advance of the peak between them measures the
+  frequency to a fraction of a cent, see measureStrobe().
+*/
+
+
+/*!
+  Constructor.
+*/
+PitchAnalyzer::PitchAnalyzer(const PcmFormat &format)
+    : m_format(format),
+      m_listener(0),
+      m_spectrumBuffer(0),
+      m_plan(0),
+      m_sampleEnergy(0),
+      m_gateEnergy(0),
+      m_cutOffPercentage(CutOffScaler),
+      m_cutOffMargin(1),
+      m_hasResult(false),
+      m_autoModeEnabled(false),
+      m_strobeModeEnabled(false),
+      m_string(-1),
+      m_detectedString(-1),
+      m_precisionPerNote(PrecisionPerNote),
+      m_maximumVoiceDifference(0),
+      m_transientSkip(0),
+      m_capturePeriod(0),
+      m_skippedFrames(0),
+      m_strobeIndex(-1),
+      m_strobePhase(0),
+      m_strobeFrequency(0),
+      m_frequency(0),
+      m_lastFrameTime(0),
+      m_position(0),
+      m_streamPosition(0),
+      m_onsetPosition(-1)
+{
+    assert(fabs(M_SAMPLE_COUNT_MULTIPLIER
+                - 2.0 / (M_TWELTH_ROOT_OF_2 - 1.0)) < 1e-6);
+    assert(m_format.isValid());
+
+    int i(2);
+    int j(1);
+
+    for (; i < MaximumOctaveRange; i *= 2) {
+        j++;
+    }
+
+    m_maximumVoiceDifference = j * 12;
+}
+
+
+/*!
+  Sets the \a listener to be notified of each analyzed frame. Not owned.
+*/
+void PitchAnalyzer::setListener(PitchAnalyzerListener *listener)
+{
+    m_listener = listener;
+}
+
+
+/*!
+  Drops the samples collected so far, so that the next frame starts from the
+  next write(). Forgets the tracked noise floor.
+*/
+void PitchAnalyzer::reset()
+{
+    m_samples.clear();
+    m_sampleEnergy = 0;
+    m_position = 0;
+    m_hasResult = false;
+    m_transientSkip = 0;
+    m_onsetPosition = -1;
+    m_skippedFrames = 0;
+    m_noiseFloor.reset();
+    m_tracker.reset();
+    m_onsetDetector.reset();
+    m_governor.reset();
+    resetStrobe();
+
+    if (m_chromatic) {
+        m_chromatic->reset();
+    }
+
+    updateCutOff();
+}
+
+
+/*!
+  Stores each stepSize() sample of the plan in use of \a data, \a length
+  bytes of PCM in the format of the analyzer, to be analysed, and accumulates
+  the energy of the stored samples. Restarts the frame on an onset. Analyzes
+  the frame as soon as it is full. Returns the amount of data written. The
+  data is dropped until there is a target, see setTuning() and
+  setFrequency().
+*/
+int64_t PitchAnalyzer::write(const char *data, int64_t length)
+{
+    const int sampleSize = m_format.bytesPerFrame();
+
+    if (m_chromatic) {
+        m_statistics.streamTime +=
+                double(length / sampleSize) / m_format.sampleRate;
+        m_readings.clear();
+        m_chromatic->write(data, length, m_streamPosition, &m_readings);
+        m_streamPosition += length / sampleSize;
+
+        for (size_t i = 0; i < m_readings.size(); ++i) {
+            analyzeChromatic(m_readings[i]);
+        }
+
+        return length;
+    }
+
+    if (!m_plan) {
+        m_streamPosition += length / sampleSize;
+        m_statistics.streamTime +=
+                double(length / sampleSize) / m_format.sampleRate;
+        return length;
+    }
+
+    const int64_t stepSizeInBytes = m_plan->stepSize() * sampleSize;
+    const int totalSampleCount = m_plan->totalSampleCount();
+
+    // assert that each sample fits fully into the data
+    assert((m_position % sampleSize) == 0);
+
+    const unsigned char *ptr = reinterpret_cast<const unsigned char *>(data);
+
+    while (m_position < length) {
+        const int16_t sample = pcmReadInt16(m_format, ptr + m_position);
+
+        if (m_onsetDetector.process(sample)) {
+            startFrameAtOnset(m_streamPosition + m_position / sampleSize);
+        }
+
+        if (m_transientSkip > 0) {
+            --m_transientSkip;
+        }
+        else {
+            m_samples.push_back(sample);
+            m_sampleEnergy += int32_t(sample) * sample;
+        }
+
+        m_position += stepSizeInBytes;
+
+        if ((int)m_samples.size() == totalSampleCount) {
+            if (m_strobeModeEnabled || m_governor.takeFrame()) {
+                const int64_t frameEnd = m_streamPosition
+                        + (m_position - stepSizeInBytes) / sampleSize + 1;
+                analyzeVoice(frameEnd);
+            }
+            else {
+                skipFrame();
+            }
+
+            if (m_strobeModeEnabled) {
+                // Keep the newer half of the frame, so that the strobe
+                // follows the phase over overlapping frames.
+                m_samples.erase(m_samples.begin(),
+                                m_samples.end() - totalSampleCount / 2);
+                m_sampleEnergy = 0;
+
+                for (size_t i = 0; i < m_samples.size(); ++i) {
+                    m_sampleEnergy += int32_t(m_samples[i]) * m_samples[i];
+                }
+
+                continue;
+            }
+
+            m_samples.clear();
+            m_sampleEnergy = 0;
+
+            if (m_capturePeriod > 0) {
+                m_position = (nextFrameStart(m_streamPosition
+                                             + m_position / sampleSize)
+                              - m_streamPosition) * sampleSize;
+            }
+            else {
+                // fast forward position to the first position after length or to the length
+                m_position += ((stepSizeInBytes - 1 + length - m_position) /
+                               stepSizeInBytes) * stepSizeInBytes;
+                break;
+            }
+        }
+    }
+
+    m_position -= length;
+    m_streamPosition += length / sampleSize;
+    m_statistics.streamTime += double(length / sampleSize) / m_format.sampleRate;
+    return length;
+}
+
+
+/*!
+  Pull-style alternative to the listener. Copies the result of the latest
+  analyzed frame to \a result and returns true, if there is a result which
+  has not been taken yet. Otherwise returns false.
+*/
+bool PitchAnalyzer::takeResult(PitchResult *result)
+{
+    if (!m_hasResult) {
+        return false;
+    }
+
+    *result = m_result;
+    m_hasResult = false;
+    return true;
+}
+
+
+/*!
+  Returns the format of the analyzed data.
+*/
+const PcmFormat &PitchAnalyzer::format() const
+{
+    return m_format;
+}
+
+
+/*!
+  Returns the tuning whose strings are analysed.
+*/
+const Tuning &PitchAnalyzer::tuning() const
+{
+    return m_tuning;
+}
+
+
+/*!
+  Sets the strings to be analysed to the strings of \a tuning, and computes
+  the analysis plans for them. Selects the first string if the selected
+  string is not in the new tuning.
+*/
+void PitchAnalyzer::setTuning(const Tuning &tuning)
+{
+    assert(tuning.isValid());
+
+    m_tuning = tuning;
+
+    if (m_string >= m_tuning.stringCount()) {
+        m_string = 0;
+    }
+
+    if (m_string >= 0) {
+        m_frequency = m_tuning.string(m_string).targetFrequency();
+    }
+
+    buildPlans();
+    selectPlan();
+}
+
+
+/*!
+  Returns the index of the selected string in the tuning, or -1 if the
+  target is a frequency outside the tuning.
+*/
+int PitchAnalyzer::string() const
+{
+    return m_string;
+}
+
+
+/*!
+  Selects the string at \a string in the tuning to be the target. The target
+  is used when the auto mode is disabled.
+*/
+void PitchAnalyzer::setString(int string)
+{
+    assert(string >= 0 && string < m_tuning.stringCount());
+
+    m_string = string;
+    m_frequency = m_tuning.string(m_string).targetFrequency();
+    selectPlan();
+}
+
+
+/*!
+  Returns the current target frequency.
+*/
+double PitchAnalyzer::frequency() const
+{
+    return m_frequency;
+}
+
+
+/*!
+  Sets the target frequency to \a frequency. Selects the string of the
+  tuning with the frequency, if any; otherwise computes a plan for the
+  frequency. The target is used when the auto mode is disabled.
+*/
+void PitchAnalyzer::setFrequency(double frequency)
+{
+    assert(frequency > 0); // Avoid division by zero
+
+    for (int i = 0; i < m_tuning.stringCount(); ++i) {
+        if (m_tuning.string(i).targetFrequency() == frequency) {
+            setString(i);
+            return;
+        }
+    }
+
+    // Keep the previous custom plan alive until the samples have been adapted
+    // from it.
+    std::unique_ptr<AnalysisPlan> previous(
+                new AnalysisPlan(m_format,
+                                 std::vector<double>(1, frequency),
+                                 std::vector<int>(1, -1),
+                                 m_precisionPerNote,
+                                 m_maximumVoiceDifference));
+    m_customPlan.swap(previous);
+    m_string = -1;
+    m_frequency = frequency;
+    selectPlan();
+}
+
+
+/*!
+  Returns true if the auto mode is enabled.
+*/
+bool PitchAnalyzer::autoModeEnabled() const
+{
+    return m_autoModeEnabled;
+}
+
+
+/*!
+  Enables the auto mode if \a autoModeEnabled is true. In the auto mode the
+  voice difference is measured from the nearest string, which is reported in
+  PitchResult::stringIndex.
+*/
+void PitchAnalyzer::setAutoModeEnabled(bool autoModeEnabled)
+{
+    if (m_autoModeEnabled != autoModeEnabled) {
+        m_autoModeEnabled = autoModeEnabled;
+        selectPlan();
+    }
+}
+
+
+/*!
+  Returns true if the chromatic mode is enabled.
+*/
+bool PitchAnalyzer::chromaticModeEnabled() const
+{
+    return m_chromatic.get() != 0;
+}
+
+
+/*!
+  Enables the chromatic mode if \a chromaticModeEnabled is true. In the
+  chromatic mode the voice difference is measured from the nearest note,
+  which is reported in PitchResult::note, regardless of the tuning and the
+  auto mode.
+*/
+void PitchAnalyzer::setChromaticModeEnabled(bool chromaticModeEnabled)
+{
+    if (chromaticModeEnabled == this->chromaticModeEnabled()) {
+        return;
+    }
+
+    if (chromaticModeEnabled) {
+        m_chromatic.reset(new ChromaticAnalyzer(m_format, m_precisionPerNote,
+                                                m_maximumVoiceDifference));
+    }
+    else {
+        m_chromatic.reset();
+    }
+
+    // The samples collected so far were not collected by the new mode.
+    m_samples.clear();
+    m_sampleEnergy = 0;
+    m_transientSkip = 0;
+    m_onsetPosition = -1;
+    m_tracker.reset();
+    m_detectedString = -1;
+    updateCutOff();
+}
+
+
+/*!
+  Takes \a cutoff, a number between 0 and 1, and derives from it the margin
+  which the peak density needs to have over the noise floor. The absolute
+  minimum cut-off, which applies when the noise floor is low, is derived from
+  it too, see updateCutOff().
+*/
+void PitchAnalyzer::setCutOffPercentage(double cutoff)
+{
+    m_cutOffPercentage = cutoff;
+    m_cutOffMargin = pow(10.0, (MinimumCutOffMarginDecibels
+                                + CutOffMarginDecibelsPerPercentage * cutoff)
+                               / 10);
+    updateCutOff();
+}
+
+
+/*!
+  Returns the maximum absolute value of PitchResult::voiceDifference.
+*/
+int PitchAnalyzer::maximumVoiceDifference() const
+{
+    return m_maximumVoiceDifference;
+}
+
+
+/*!
+  Returns the maximum precision per note near the target frequency.
+*/
+int PitchAnalyzer::maximumPrecisionPerNote() const
+{
+    return m_precisionPerNote;
+}
+
+
+/*!
+  Sets the frame length so that the precision is 1 / \a precisionPerNote
+  notes near the target frequency. A smaller precision gives shorter frames,
+  i.e. faster but noisier measurements. Drops the samples collected so far.
+*/
+void PitchAnalyzer::setPrecisionPerNote(int precisionPerNote)
+{
+    assert(precisionPerNote > 0);
+
+    if (precisionPerNote == m_precisionPerNote) {
+        return;
+    }
+
+    m_precisionPerNote = precisionPerNote;
+    buildPlans();
+
+    if (m_customPlan) {
+        m_customPlan.reset(new AnalysisPlan(m_format,
+                                            std::vector<double>(1, m_frequency),
+                                            std::vector<int>(1, -1),
+                                            m_precisionPerNote,
+                                            m_maximumVoiceDifference));
+    }
+
+    if (m_chromatic) {
+        m_chromatic.reset(new ChromaticAnalyzer(m_format, m_precisionPerNote,
+                                                m_maximumVoiceDifference));
+    }
+
+    selectPlan();
+    reset();
+}
+
+
+/*!
+  Returns the number of sample frames the audio device delivers at a time,
+  or 0 if it is not known.
+*/
+int PitchAnalyzer::capturePeriod() const
+{
+    return m_capturePeriod;
+}
+
+
+/*!
+  Sets the number of sample frames the audio device delivers at a time to
+  \a sampleCount, 0 if it is not known. The frames are scheduled to end at
+  the end of a period. Drops the samples collected so far.
+*/
+void PitchAnalyzer::setCapturePeriod(int sampleCount)
+{
+    assert(sampleCount >= 0);
+
+    if (sampleCount == m_capturePeriod) {
+        return;
+    }
+
+    m_capturePeriod = sampleCount;
+    reset();
+}
+
+
+/*!
+  Returns the number of sample frames between the ends of two frames of the
+  plan in use when the capture period is known or in the strobe mode, or 0
+  otherwise.
+*/
+int PitchAnalyzer::hopSize() const
+{
+    if (!m_plan) {
+        return 0;
+    }
+
+    if (m_strobeModeEnabled) {
+        const int totalSampleCount = m_plan->totalSampleCount();
+        return (totalSampleCount - totalSampleCount / 2) * m_plan->stepSize();
+    }
+
+    if (m_capturePeriod == 0) {
+        return 0;
+    }
+
+    const int frameSpan = (m_plan->totalSampleCount() - 1)
+            * m_plan->stepSize() + 1;
+    return (frameSpan + m_capturePeriod - 1) / m_capturePeriod
+            * m_capturePeriod;
+}
+
+
+/*!
+  Returns true if the power governor duty cycles the analysis.
+*/
+bool PitchAnalyzer::powerSavingEnabled() const
+{
+    return m_governor.isEnabled();
+}
+
+
+/*!
+  Lets the power governor skip frames while the readings are stable or
+  silent if \a powerSavingEnabled is true, see PowerGovernor. An onset or a
+  changing reading restores the full rate. Does not apply to the chromatic
+  mode.
+*/
+void PitchAnalyzer::setPowerSavingEnabled(bool powerSavingEnabled)
+{
+    m_governor.setEnabled(powerSavingEnabled);
+}
+
+
+/*!
+  Returns true if the strobe mode is enabled.
+*/
+bool PitchAnalyzer::strobeModeEnabled() const
+{
+    return m_strobeModeEnabled;
+}
+
+
+/*!
+  Enables the strobe mode if \a strobeModeEnabled is true. Consecutive
+  frames then overlap by half, none are skipped by the power governor, and
+  the results carry the difference from the target measured from the phase
+  advance of the peak, see PitchResult::strobeCents. Does not apply to the
+  chromatic mode. Drops the samples collected so far.
+*/
+void PitchAnalyzer::setStrobeModeEnabled(bool strobeModeEnabled)
+{
+    if (strobeModeEnabled == m_strobeModeEnabled) {
+        return;
+    }
+
+    m_strobeModeEnabled = strobeModeEnabled;
+    reset();
+}
+
+
+/*!
+  Publishes the spectrum and the samples of each analyzed frame to
+  \a buffer, if not 0, for visualization. Does not apply to the chromatic
+  mode.
+*/
+void PitchAnalyzer::setSpectrumBuffer(SpectrumBuffer *buffer)
+{
+    m_spectrumBuffer = buffer;
+}
+
+
+/*!
+  Returns the tracked noise floor in decibels relative to the full scale.
+*/
+double PitchAnalyzer::noiseFloorLevel() const
+{
+    const double fullScale = (m_format.sampleSize == 8)
+            ? M_MAX_AMPLITUDE_8BIT_SIGNED : M_MAX_AMPLITUDE_16BIT_SIGNED;
+
+    return 10 * log10(m_noiseFloor.floor() / (fullScale * fullScale));
+}
+
+
+/*!
+  Returns the work counters of the analyzer.
+*/
+const PitchAnalyzerStatistics &PitchAnalyzer::statistics() const
+{
+    return m_statistics;
+}
+
+
+/*!
+  Zeroes the work counters of the analyzer.
+*/
+void PitchAnalyzer::resetStatistics()
+{
+    m_statistics = PitchAnalyzerStatistics();
+}
+
+
+/*!
+  Drops the samples collected before the onset at \a streamPosition, and
+  skips the attack transient.
+*/
+void PitchAnalyzer::startFrameAtOnset(int64_t streamPosition)
+{
+    m_samples.clear();
+    m_sampleEnergy = 0;
+    m_transientSkip = m_plan->transientSkip();
+    m_onsetPosition = streamPosition;
+    m_statistics.onsetsDetected++;
+    m_governor.wake();
+    resetStrobe();
+}
+
+
+/*!
+  Returns the stream position, at \a streamPosition or after it, where the
+  next frame starts so that it ends at the end of a capture period.
+*/
+int64_t PitchAnalyzer::nextFrameStart(int64_t streamPosition) const
+{
+    // The last sample of a frame is this far from its first one.
+    const int64_t frameSpan = int64_t(m_plan->totalSampleCount() - 1)
+            * m_plan->stepSize() + 1;
+    const int64_t end = streamPosition + frameSpan;
+    const int64_t periodEnd = (end + m_capturePeriod - 1) / m_capturePeriod
+            * m_capturePeriod;
+    return streamPosition + (periodEnd - end);
+}
+
+
+/*!
+  Analyzes the voice frequency and reports the result. Frames which are too
+  quiet to pass the cut-off are reported as low voice without running the FFT.
+  \a streamPosition is the position of the end of the frame in the stream.
+*/
+void PitchAnalyzer::analyzeVoice(int64_t streamPosition)
+{
+    const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    const AnalysisPlan &plan = *m_plan;
+    FastFourierTransformer &fftHelper = plan.fftHelper();
+    int index = -1;
+    bool isTonal = false;
+    PitchResult result;
+    const double energy = double(m_sampleEnergy) / plan.totalSampleCount();
+    const bool isAnalyzed = m_sampleEnergy > m_gateEnergy;
+
+    if (isAnalyzed) {
+        fftHelper.calculateFFT(&m_samples[0], (int)m_samples.size());
+        index = fftHelper.getMaximumDensityIndex(plan.firstIndex(),
+                                                 plan.lastIndex());
+        isTonal = fftHelper.getMaximumDensitySquared()
+                > TonalPeakRatio * plan.noisePeakFactor() * energy;
+        m_statistics.framesAnalyzed++;
+    }
+    else {
+        m_statistics.framesGated++;
+    }
+
+    // Track the noise floor and adapt the cut-off for the next frame.
+    m_noiseFloor.update(energy, plan.frameDuration(), isTonal);
+    updateCutOff();
+
+    // The peak interpolated between the bins, in semitones.
+    double measuredDifference = 0;
+
+    // If index == -1, the voice is to be filtered away.
+    if (index != -1) {
+        // Look up the nearest string.
+        const int string = plan.string(index);
+
+        if (string != m_detectedString) {
+            // The voice difference is relative to another string now.
+            m_detectedString = string;
+            m_tracker.reset();
+        }
+
+        result.stringIndex = string;
+        measuredDifference = reportVoice(&result, index, streamPosition);
+
+        if (m_strobeModeEnabled) {
+            measureStrobe(&result, index, streamPosition);
+        }
+    }
+    else {
+        m_tracker.updateLowVoice();
+        resetStrobe();
+    }
+
+    PowerGovernor::Activity activity = PowerGovernor::Silent;
+
+    if (index != -1) {
+        const bool isStable = m_tracker.confidence() >= StableConfidence
+                && fabs(measuredDifference - m_tracker.voiceDifference())
+                   <= StableDifference;
+        activity = isStable ? PowerGovernor::Stable : PowerGovernor::Changing;
+    }
+
+    m_governor.update(activity, plan.frameDuration());
+    m_skippedFrames = 0;
+
+    if (m_spectrumBuffer) {
+        publishSpectrum(isAnalyzed, index, streamPosition);
+    }
+
+    publishResult(result);
+
+    m_lastFrameTime = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+    m_statistics.analysisTime += m_lastFrameTime;
+}
+
+
+/*!
+  Drops a complete frame which the power governor skips. The time it would
+  have taken to analyze is estimated by the last analyzed frame.
+*/
+void PitchAnalyzer::skipFrame()
+{
+    m_statistics.framesSkipped++;
+    m_skippedFrames++;
+    m_statistics.savedTime += m_lastFrameTime;
+}
+
+
+/*!
+  Publishes the samples of the frame ending at \a streamPosition to the
+  spectrum buffer, with its spectrum if \a isAnalyzed, i.e. the FFT was
+  calculated, and the peak at \a index if not -1.
+*/
+void PitchAnalyzer::publishSpectrum(bool isAnalyzed, int index,
+                                    int64_t streamPosition)
+{
+    const AnalysisPlan &plan = *m_plan;
+    Spectrum &spectrum = m_spectrumBuffer->back();
+    spectrum.binWidth = plan.indexToFrequency();
+    spectrum.firstFrequency = plan.firstIndex() * spectrum.binWidth;
+    spectrum.peakFrequency = 0;
+    spectrum.streamPosition = streamPosition;
+
+    if (isAnalyzed) {
+        FastFourierTransformer &fftHelper = plan.fftHelper();
+        spectrum.densities.resize(plan.lastIndex() - plan.firstIndex() + 1);
+        fftHelper.getDensitiesSquared(&spectrum.densities[0],
+                                      plan.firstIndex(), plan.lastIndex());
+
+        if (index != -1) {
+            spectrum.peakFrequency = (index + fftHelper.getPeakOffset(index))
+                    * spectrum.binWidth;
+        }
+    }
+    else {
+        spectrum.densities.clear();
+    }
+
+    spectrum.waveform.resize(m_samples.size());
+
+    for (size_t i = 0; i < m_samples.size(); ++i) {
+        spectrum.waveform[i] = m_samples[i] * (1.0f / 32768);
+    }
+
+    m_spectrumBuffer->publish();
+}
+
+
+/*!
+  Reports \a reading of ChromaticAnalyzer. The noise floor follows the lane
+  with the shortest frames, which also reports the low voice. The other
+  readings are reported only if their peak is among the notes of their lane.
+*/
+void PitchAnalyzer::analyzeChromatic(const ChromaticReading &reading)
+{
+    if (reading.isGated) {
+        m_statistics.framesGated++;
+    }
+    else {
+        m_statistics.framesAnalyzed++;
+    }
+
+    if (reading.isFastest) {
+        m_noiseFloor.update(reading.energy, reading.frameDuration,
+                            reading.isTonal);
+        updateCutOff();
+    }
+
+    PitchResult result;
+
+    if (reading.isInBand) {
+        if (reading.note != m_detectedString) {
+            // The voice difference is relative to another note now.
+            m_detectedString = reading.note;
+            m_tracker.reset();
+        }
+
+        result.isLowVoice = false;
+        result.isCorrectFrequency = (reading.index == reading.correctIndex);
+        result.voiceDifference = reading.voiceDifference;
+        result.frequency = reading.frequency;
+        result.note = reading.note;
+        m_tracker.update(reading.interpolatedVoiceDifference,
+                         reading.frameDuration);
+    }
+    else if (reading.isFastest && reading.isLowVoice) {
+        m_tracker.updateLowVoice();
+    }
+    else {
+        // The voice belongs to another lane.
+        return;
+    }
+
+    publishResult(result);
+}
+
+
+/*!
+  Completes \a result with the tracked voice difference, stores it to be
+  taken and notifies the listener.
+*/
+void PitchAnalyzer::publishResult(const PitchResult &result)
+{
+    m_result = result;
+    m_result.smoothedVoiceDifference = m_tracker.voiceDifference();
+    m_result.confidence = m_tracker.confidence();
+    m_hasResult = true;
+
+    if (m_listener) {
+        m_listener->pitchAnalyzed(m_result);
+    }
+}
+
+
+/*!
+  Fills in \a result for a frame whose peak is at \a index. Updates the onset
+  latency and the tracker. \a streamPosition is the end of the frame.
+
+  Returns the voice difference of the peak interpolated between the bins,
+  which is what the tracker is fed with.
+*/
+double PitchAnalyzer::reportVoice(PitchResult *result, int index,
+                                  int64_t streamPosition)
+{
+    const AnalysisPlan &plan = *m_plan;
+    const int correctIndex = plan.correctIndex(index);
+    const double value = plan.voiceDifference(index);
+
+    result->isLowVoice = false;
+    result->voiceDifference = value;
+    result->frequency = index * plan.indexToFrequency();
+
+    // If the correctIndex is index, the frequency is correct.
+    result->isCorrectFrequency = (correctIndex == index);
+
+    if (m_onsetPosition >= 0) {
+        // The first reading after an onset.
+        m_statistics.lastOnsetLatency =
+                double(streamPosition - m_onsetPosition) / m_format.sampleRate;
+        m_statistics.totalOnsetLatency += m_statistics.lastOnsetLatency;
+        m_statistics.onsetsMeasured++;
+        m_onsetPosition = -1;
+    }
+
+    // Feed the tracker with the peak interpolated between the bins, so
+    // that the smoothed value is not limited to the bin resolution. The
+    // frames skipped by the governor since the last one have passed too.
+    const double interpolated = plan.voiceDifference(
+                index, plan.fftHelper().getPeakOffset(index));
+    m_tracker.update(interpolated,
+                     plan.frameDuration() * (m_skippedFrames + 1));
+
+    return interpolated;
+}
+
+
+/*!
+  Fills in the strobe values of \a result for a frame whose peak is at
+  \a index, ending at \a streamPosition.
+
+  The phase of a steady voice advances by 2 * pi * frequency * hop between
+  frames which start hop seconds apart, at any bin next to the peak. The
+  advance is unwrapped with the frequency measured so far, or the
+  interpolated peak for the first hop, and accumulated to a mark per frame.
+  The frequency is the phase advanced between the oldest and the newest
+  mark, so the precision grows with the baseline instead of being limited by
+  the bin width. No other transforms are needed.
+*/
+void PitchAnalyzer::measureStrobe(PitchResult *result, int index,
+                                  int64_t streamPosition)
+{
+    const AnalysisPlan &plan = *m_plan;
+    const FastFourierTransformer &fftHelper = plan.fftHelper();
+    const double binWidth = plan.indexToFrequency();
+    const int64_t frameStart = streamPosition
+            - (int64_t(plan.totalSampleCount() - 1) * plan.stepSize() + 1);
+    const double peak = (index + fftHelper.getPeakOffset(index)) * binWidth;
+    const double reference = m_strobeFrequency > 0 ? m_strobeFrequency : peak;
+    double hop = 0;
+
+    if (!m_strobeMarks.empty()) {
+        hop = double(frameStart - m_strobeMarks.back().position)
+                / m_format.sampleRate;
+    }
+
+    if (m_strobeIndex < 0 || abs(index - m_strobeIndex) > 1 || hop <= 0
+            || hop > MaximumStrobeHop * plan.frameDuration()
+            || fabs(reference - peak) > MaximumStrobeDrift * binWidth) {
+        // Start over from this frame.
+        resetStrobe();
+        StrobeMark mark = { frameStart, 0 };
+        m_strobeMarks.push_back(mark);
+        m_strobeIndex = index;
+        m_strobePhase = fftHelper.getPhase(index);
+        return;
+    }
+
+    // Compare the phases of the same bin, and keep the phase of the peak for
+    // the next frame.
+    const double turns = (fftHelper.getPhase(m_strobeIndex) - m_strobePhase)
+            / (2 * M_PI);
+    const double advance = turns + floor(reference * hop - turns + 0.5);
+    StrobeMark mark = { frameStart, m_strobeMarks.back().turns + advance };
+    m_strobeMarks.push_back(mark);
+    m_strobeIndex = index;
+    m_strobePhase = fftHelper.getPhase(index);
+
+    const int64_t baseline = int64_t(StrobeBaseline * m_format.sampleRate);
+
+    while (m_strobeMarks.size() > 2
+           && frameStart - m_strobeMarks[1].position >= baseline) {
+        m_strobeMarks.erase(m_strobeMarks.begin());
+    }
+
+    const StrobeMark &first = m_strobeMarks.front();
+    m_strobeFrequency = (mark.turns - first.turns) * m_format.sampleRate
+            / double(mark.position - first.position);
+
+    const double target = result->stringIndex >= 0
+            ? m_tuning.string(result->stringIndex).targetFrequency()
+            : m_frequency;
+
+    result->hasStrobe = true;
+    result->strobeCents = 1200 * log2(m_strobeFrequency / target);
+    result->strobeBeat = m_strobeFrequency - target;
+}
+
+
+/*!
+  Forgets the phase followed by the strobe.
+*/
+void PitchAnalyzer::resetStrobe()
+{
+    m_strobeMarks.clear();
+    m_strobeIndex = -1;
+    m_strobePhase = 0;
+    m_strobeFrequency = 0;
+}
+
+
+/*!
+  Computes the plan of each string of the tuning, and the wide-band plan of
+  all the strings for the auto mode.
+*/
+void PitchAnalyzer::buildPlans()
+{
+    const std::vector<double> frequencies = m_tuning.targetFrequencies();
+    const int stringCount = (int)frequencies.size();
+    std::vector<int> strings;
+
+    // The plan in use is about to be destroyed.
+    m_plan = 0;
+    m_stringPlans.clear();
+    m_widePlan.reset();
+
+    // Each string is decimated by the largest multiple of the step of the
+    // next higher string that its frequency allows, starting from the step
+    // of the wide-band plan. The steps are then multiples of each other, so
+    // adaptSamples() keeps the samples when switching to a lower string or
+    // from the auto mode, while each frame is less than twice as long as
+    // with the step of the string alone.
+    std::vector<std::pair<double, int> > order; // Frequency, string
+    std::vector<int> steps(stringCount);
+
+    for (int i = 0; i < stringCount; ++i) {
+        order.push_back(std::make_pair(frequencies[i], i));
+    }
+
+    std::sort(order.rbegin(), order.rend());
+
+    for (int i = 0, step = 0; i < stringCount; ++i) {
+        const int maximum =
+                AnalysisPlan::maximumStepSize(m_format, order[i].first);
+        step = step > 0 ? maximum / step * step : maximum;
+        steps[order[i].second] = step;
+    }
+
+    for (int i = 0; i < stringCount; ++i) {
+        m_stringPlans.push_back(std::unique_ptr<AnalysisPlan>(
+                new AnalysisPlan(m_format,
+                                 std::vector<double>(1, frequencies[i]),
+                                 std::vector<int>(1, i),
+                                 m_precisionPerNote,
+                                 m_maximumVoiceDifference,
+                                 steps[i])));
+        strings.push_back(i);
+    }
+
+    if (stringCount > 0) {
+        m_widePlan.reset(new AnalysisPlan(m_format, frequencies, strings,
+                                          m_precisionPerNote,
+                                          m_maximumVoiceDifference));
+    }
+}
+
+
+/*!
+  Switches to the plan of the wide band in the auto mode, and otherwise to
+  the plan of the selected string or frequency. Keeps the samples collected
+  so far if they can be continued with the new plan, see adaptSamples(), and
+  drops them otherwise, so that no frame mixes two sample rates.
+*/
+void PitchAnalyzer::selectPlan()
+{
+    const AnalysisPlan *plan = m_customPlan.get();
+
+    if (m_autoModeEnabled && m_widePlan) {
+        plan = m_widePlan.get();
+    }
+    else if (m_string >= 0) {
+        plan = m_stringPlans[m_string].get();
+    }
+
+    if (!plan || plan == m_plan) {
+        return;
+    }
+
+    if (!m_plan || !adaptSamples(*m_plan, *plan)) {
+        m_samples.clear();
+        m_sampleEnergy = 0;
+        m_transientSkip = 0;
+        m_onsetDetector.reset();
+    }
+
+    m_samples.reserve(plan->totalSampleCount());
+    m_onsetDetector.setRates(plan->onsetRates());
+    m_plan = plan;
+    m_tracker.reset();
+    m_skippedFrames = 0;
+    m_governor.wake();
+    resetStrobe();
+    m_detectedString = -1;
+    updateCutOff();
+}
+
+
+/*!
+  Converts the samples collected with the plan \a from to be continued with
+  the plan \a to, and returns true. Returns false if the samples are not
+  compatible, i.e. \a to decimates less than \a from, or not by a multiple
+  of it.
+
+  The samples decimated by \a from are further decimated, counting back from
+  the newest one, and the oldest ones are dropped if the frame of \a to is
+  shorter. The position of the next sample is moved accordingly.
+*/
+bool PitchAnalyzer::adaptSamples(const AnalysisPlan &from,
+                                 const AnalysisPlan &to)
+{
+    if (to.stepSize() % from.stepSize() != 0) {
+        return false;
+    }
+
+    const int ratio = to.stepSize() / from.stepSize();
+    const int size = (int)m_samples.size();
+    const int count = std::min(to.totalSampleCount(),
+                               (size + ratio - 1) / ratio);
+
+    if (ratio == 1 && count == size) {
+        // Nothing to convert.
+        return true;
+    }
+
+    // The source index is never below the destination index, so the
+    // samples can be moved in place.
+    m_sampleEnergy = 0;
+
+    for (int i = 0; i < count; ++i) {
+        const int16_t sample = m_samples[size - 1 - (count - 1 - i) * ratio];
+        m_samples[i] = sample;
+        m_sampleEnergy += int32_t(sample) * sample;
+    }
+
+    m_samples.resize(count);
+    m_position += int64_t(to.stepSize() - from.stepSize())
+            * m_format.bytesPerFrame();
+    m_transientSkip = (m_transientSkip + ratio - 1) / ratio;
+    return true;
+}
+
+
+/*!
+  Sets the density cut-off to be the larger of the absolute minimum cut-off
+  and the expected peak density of the noise floor scaled by the margin. The
+  absolute minimum cut-off is the cut-off percentage scaled with
+  CutOffScaler and multiplied with the maximum density of the frame.
+
+  Also derives the energy gate from the cut-off. By Parseval's theorem the
+  squared density of any single bin of a real signal is at most
+  N * energy / 2, so a frame whose energy is at most 2 * cutoff^2 / N can not
+  pass the density cut-off, and its FFT can be skipped without changing the
+  result.
+*/
+void PitchAnalyzer::updateCutOff()
+{
+    double minimumAmplitude = 0;
+
+    if (m_format.sampleSize == 8) {
+        minimumAmplitude = MinimumCutOffShare * CutOffScaler
+                * m_cutOffPercentage * M_MAX_AMPLITUDE_8BIT_SIGNED;
+    }
+    else if (m_format.sampleSize == 16) {
+        minimumAmplitude = MinimumCutOffShare * CutOffScaler
+                * m_cutOffPercentage * M_MAX_AMPLITUDE_16BIT_SIGNED;
+    }
+
+    if (m_chromatic) {
+        m_chromatic->setCutOff(minimumAmplitude, m_noiseFloor.isTracking()
+                               ? m_cutOffMargin * m_noiseFloor.floor() : 0);
+        return;
+    }
+
+    if (!m_plan) {
+        return;
+    }
+
+    const double totalSampleCount = m_plan->totalSampleCount();
+    const double minimumCutOff = minimumAmplitude * totalSampleCount;
+    double cutOffSquared = minimumCutOff * minimumCutOff;
+
+    if (m_noiseFloor.isTracking()) {
+        const double noiseCutOffSquared =
+                m_cutOffMargin * m_plan->noisePeakFactor() * m_noiseFloor.floor();
+
+        if (noiseCutOffSquared > cutOffSquared) {
+            cutOffSquared = noiseCutOffSquared;
+        }
+    }
+
+    m_plan->fftHelper().setCutOffForDensity(sqrt(cutOffSquared));
+    m_gateEnergy = 2.0 * cutOffSquared / totalSampleCount;
+
+    // An onset needs to be louder than a sine at the minimum cut-off, and
+    // clearly louder than the noise floor.
+    double onsetThreshold = 2.0 * minimumCutOff * minimumCutOff
+            / (totalSampleCount * totalSampleCount);
+
+    if (m_noiseFloor.isTracking()
+            && OnsetFloorRatio * m_noiseFloor.floor() > onsetThreshold) {
+        onsetThreshold = OnsetFloorRatio * m_noiseFloor.floor();
+    }
+
+    m_onsetDetector.setThreshold(onsetThreshold);
+}
@@ -0,0 +1,179 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef PITCHANALYZER_H
+#define PITCHANALYZER_H
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "analysisplan.h"
+#include "chromaticanalyzer.h"
+#include "noisefloorestimator.h"
+#include "onsetdetector.h"
+#include "pcmformat.h"
+#include "pitchtracker.h"
+#include "powergovernor.h"
+#include "spectrumbuffer.h"
+#include "tuning.h"
+
+
+struct PitchResult
+{
+    PitchResult();
+
+    bool isLowVoice;
+    bool isCorrectFrequency;
+    double voiceDifference; // In semitones from the target frequency
+    double frequency; // Detected frequency in Hz
+    double smoothedVoiceDifference; // Voice difference tracked over frames
+    double confidence; // Confidence of the smoothed value, from 0 to 1
+    int stringIndex; // The measured string of the tuning, or -1
+    int note; // The nearest note in the chromatic mode, otherwise -1
+    bool hasStrobe; // True if the strobe values below are measured
+    double strobeCents; // Phase-measured difference in cents from the target
+    double strobeBeat; // Phase-measured difference in Hz from the target
+};
+
+
+struct PitchAnalyzerStatistics
+{
+    PitchAnalyzerStatistics();
+
+    double skipRatio() const;
+    double averageOnsetLatency() const;
+    double savedTimePerMinute() const;
+
+    int64_t framesAnalyzed; // Frames which went through the FFT
+    int64_t framesGated; // Frames rejected by the energy gate
+    int64_t onsetsDetected;
+    int64_t onsetsMeasured; // Onsets followed by a reading
+    double lastOnsetLatency; // Seconds from an onset to the first reading
+    double totalOnsetLatency;
+    int64_t framesSkipped; // Frames dropped by the power governor
+    double analysisTime; // Seconds spent analyzing the frames
+    double savedTime; // Estimated seconds saved by the skipped frames
+    double streamTime; // Seconds of audio written
+};
+
+
+class PitchAnalyzerListener
+{
+public:
+    virtual ~PitchAnalyzerListener() {}
+    virtual void pitchAnalyzed(const PitchResult &result) = 0;
+};
+
+
+class PitchAnalyzer
+{
+public:
+    explicit PitchAnalyzer(const PcmFormat &format);
+
+public:
+    void setListener(PitchAnalyzerListener *listener);
+    void reset();
+    int64_t write(const char *data, int64_t length);
+    bool takeResult(PitchResult *result);
+    const PcmFormat &format() const;
+    const Tuning &tuning() const;
+    void setTuning(const Tuning &tuning);
+    int string() const;
+    void setString(int string);
+    double frequency() const;
+    void setFrequency(double frequency);
+    void setCutOffPercentage(double cutoff);
+    bool autoModeEnabled() const;
+    void setAutoModeEnabled(bool autoModeEnabled);
+    bool chromaticModeEnabled() const;
+    void setChromaticModeEnabled(bool chromaticModeEnabled);
+    int maximumVoiceDifference() const;
+    int maximumPrecisionPerNote() const;
+    void setPrecisionPerNote(int precisionPerNote);
+    int capturePeriod() const;
+    void setCapturePeriod(int sampleCount);
+    int hopSize() const;
+    bool powerSavingEnabled() const;
+    void setPowerSavingEnabled(bool powerSavingEnabled);
+    bool strobeModeEnabled() const;
+    void setStrobeModeEnabled(bool strobeModeEnabled);
+    void setSpectrumBuffer(SpectrumBuffer *buffer);
+    double noiseFloorLevel() const;
+    const PitchAnalyzerStatistics &statistics() const;
+    void resetStatistics();
+
+private:
+    void buildPlans();
+    void selectPlan();
+    bool adaptSamples(const AnalysisPlan &from, const AnalysisPlan &to);
+    void startFrameAtOnset(int64_t streamPosition);
+    int64_t nextFrameStart(int64_t streamPosition) const;
+    void analyzeVoice(int64_t streamPosition);
+    void skipFrame();
+    void publishSpectrum(bool isAnalyzed, int index, int64_t streamPosition);
+    void analyzeChromatic(const ChromaticReading &reading);
+    void publishResult(const PitchResult &result);
+    double reportVoice(PitchResult *result, int index,
+                       int64_t streamPosition);
+    void measureStrobe(PitchResult *result, int index, int64_t streamPosition);
+    void resetStrobe();
+    void updateCutOff();
+
+private:
+    // Not copyable
+    PitchAnalyzer(const PitchAnalyzer &);
+    PitchAnalyzer &operator=(const PitchAnalyzer &);
+
+private:
+    struct StrobeMark
+    {
+        int64_t position; // Stream position of the first sample of a frame
+        double turns; // Phase of the voice since the first mark, in turns
+    };
+
+private:
+    NoiseFloorEstimator m_noiseFloor;
+    PitchTracker m_tracker;
+    OnsetDetector m_onsetDetector;
+    PowerGovernor m_governor;
+    const PcmFormat m_format;
+    PitchAnalyzerListener *m_listener; // Not owned
+    SpectrumBuffer *m_spectrumBuffer; // Not owned
+    std::vector<int16_t> m_samples;
+    Tuning m_tuning;
+    std::vector<std::unique_ptr<AnalysisPlan> > m_stringPlans;
+    std::unique_ptr<AnalysisPlan> m_widePlan; // All the strings at once
+    std::unique_ptr<AnalysisPlan> m_customPlan; // Frequency outside the tuning
+    std::unique_ptr<ChromaticAnalyzer> m_chromatic; // In the chromatic mode
+    std::vector<ChromaticReading> m_readings;
+    std::vector<StrobeMark> m_strobeMarks; // Oldest first
+    const AnalysisPlan *m_plan; // The plan in use
+    int64_t m_sampleEnergy; // Sum of squares of m_samples
+    double m_gateEnergy;
+    double m_cutOffPercentage;
+    double m_cutOffMargin;
+    PitchResult m_result;
+    PitchAnalyzerStatistics m_statistics;
+    bool m_hasResult;
+    bool m_autoModeEnabled;
+    bool m_strobeModeEnabled;
+    int m_string; // Index of the selected string, or -1
+    int m_detectedString; // Or the detected note in the chromatic mode
+    int m_precisionPerNote;
+    int m_maximumVoiceDifference;
+    int m_transientSkip; // Samples still to be skipped after an onset
+    int m_capturePeriod; // Sample frames per write, or 0 if not known
+    int m_skippedFrames; // Skipped by the governor since the last analysis
+    int m_strobeIndex; // Peak index of the last strobe mark, or -1
+    float m_strobePhase; // Phase of m_strobeIndex in the last frame
+    double m_strobeFrequency; // Measured over the marks, or 0
+    double m_frequency;
+    double m_lastFrameTime; // Seconds spent analyzing the last frame
+    int64_t m_position;
+    int64_t m_streamPosition; // Sample frames written before this write()
+    int64_t m_onsetPosition; // Stream position of the last unmeasured onset
+};
+
+#endif // PITCHANALYZER_H
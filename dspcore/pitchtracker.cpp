@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "pitchtracker.h"
+
+#include <math.h>
+
+// Gains of the alpha-beta filter.
+const static double Alpha(0.5);
+const static double Beta(0.1);
+
+// A measurement further than this many semitones from the prediction is an
+// outlier.
+const static double OutlierSemitones(0.75);
+
+// Number of consecutive outliers, each within OutlierSemitones of the
+// previous one, after which they are taken to be a new note.
+const static int OutliersForNewNote(2);
+
+// Number of consecutive low voice frames after which the note has ended.
+const static int LowVoicesForSilence(3);
+
+// How fast the confidence decays on an outlier or on low voice.
+const static double ConfidenceDecay(0.5);
+
+
+/*!
+  \class PitchTracker
+  \brief Smooths the voice difference of consecutive frames.
+
+  An alpha-beta filter on the voice difference, which is a logarithm of the
+  frequency. Measurements far from the prediction are rejected as outliers
+  until they repeat, i.e. consecutive outliers agree with each other, in
+  which case the tracker jumps to the new note. The
+  confidence, a number between 0 and 1, grows with measurements agreeing
+  with the prediction and decays with outliers and low voice.
+*/
+
+
+/*!
+  Constructor.
+*/
+PitchTracker::PitchTracker()
+    : m_value(0),
+      m_velocity(0),
+      m_confidence(0),
+      m_outlierValue(0),
+      m_outlierCount(0),
+      m_lowVoiceCount(0),
+      m_isTracking(false)
+{
+}
+
+
+/*!
+  Forgets the tracked note.
+*/
+void PitchTracker::reset()
+{
+    m_value = 0;
+    m_velocity = 0;
+    m_confidence = 0;
+    m_outlierValue = 0;
+    m_outlierCount = 0;
+    m_lowVoiceCount = 0;
+    m_isTracking = false;
+}
+
+
+/*!
+  Updates the tracker with the \a voiceDifference of a frame analyzed
+  \a interval seconds after the previous one.
+*/
+void PitchTracker::update(double voiceDifference, double interval)
+{
+    m_lowVoiceCount = 0;
+
+    if (!m_isTracking) {
+        m_value = voiceDifference;
+        m_velocity = 0;
+        m_isTracking = true;
+        return;
+    }
+
+    const double prediction = m_value + m_velocity * interval;
+    const double residual = voiceDifference - prediction;
+
+    if (fabs(residual) > OutlierSemitones) {
+        m_confidence *= ConfidenceDecay;
+
+        // An outlier disagreeing with the previous one starts a new run.
+        if (m_outlierCount > 0
+                && fabs(voiceDifference - m_outlierValue) <= OutlierSemitones) {
+            m_outlierCount++;
+        }
+        else {
+            m_outlierCount = 1;
+        }
+
+        m_outlierValue = voiceDifference;
+
+        if (m_outlierCount >= OutliersForNewNote) {
+            // The outliers agree with each other more than with the track.
+            m_value = voiceDifference;
+            m_velocity = 0;
+            m_outlierCount = 0;
+        }
+
+        return;
+    }
+
+    m_outlierCount = 0;
+    m_value = prediction + Alpha * residual;
+
+    if (interval > 0) {
+        m_velocity += Beta * residual / interval;
+    }
+
+    m_confidence += (1 - m_confidence) * Alpha
+            * (1 - fabs(residual) / OutlierSemitones);
+}
+
+
+/*!
+  Updates the tracker with a frame in which no voice was found.
+*/
+void PitchTracker::updateLowVoice()
+{
+    m_confidence *= ConfidenceDecay;
+
+    if (++m_lowVoiceCount >= LowVoicesForSilence) {
+        reset();
+    }
+}
+
+
+/*!
+  Returns true if a note is being tracked.
+*/
+bool PitchTracker::isTracking() const
+{
+    return m_isTracking;
+}
+
+
+/*!
+  Returns the smoothed voice difference in semitones.
+*/
+double PitchTracker::voiceDifference() const
+{
+    return m_value;
+}
+
+
+/*!
+  Returns the confidence of the smoothed voice difference.
+*/
+double PitchTracker::confidence() const
+{
+    return m_confidence;
+}
@@ -0,0 +1,32 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef PITCHTRACKER_H
+#define PITCHTRACKER_H
+
+
+class PitchTracker
+{
+public:
+    PitchTracker();
+
+public:
+    void reset();
+    void update(double voiceDifference, double interval);
+    void updateLowVoice();
+    bool isTracking() const;
+    double voiceDifference() const;
+    double confidence() const;
+
+private:
+    double m_value; // Semitones from the target frequency
+    double m_velocity; // Semitones per second
+    double m_confidence;
+    double m_outlierValue; // The latest outlier, in semitones
+    int m_outlierCount; // Of the run of outliers agreeing with each other
+    int m_lowVoiceCount;
+    bool m_isTracking;
+};
+
+#endif // PITCHTRACKER_H
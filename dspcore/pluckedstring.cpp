@@ -0,0 +1,165 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "pluckedstring.h"
+
+#include <assert.h>
+#include <math.h>
+
+// The time in which a plucked string decays by 60 dB.
+const double DecaySeconds(4.0);
+
+// The delay of the allpass filter is kept between these, where its phase
+// delay is flat enough and its coefficient far enough from -1.
+const double MinimumAllpassDelay(0.1);
+
+// The share of each new noise sample in the excitation. Smaller values
+// soften the pluck.
+const float PluckSoftness(0.5f);
+
+
+/*!
+  \class PluckedString
+  \brief Synthesizes a plucked string with the Karplus-Strong algorithm.
+
+  A burst of noise circulates in a delay line, through a two point average
+  which damps the high harmonics faster than the low ones, like a real
+  string does. The average delays the loop by half a sample and a first
+  order allpass filter adds the rest of the fraction of a sample, so that
+  the period is exactly the sample rate divided by the frequency and not
+  only rounded to whole samples.
+
+  The delay line is allocated once for the lowest frequency, so changing the
+  frequency or plucking does not allocate. Rendering costs a few operations
+  per sample.
+*/
+
+
+/*!
+  Constructor. The string can be tuned down to \a minimumFrequency at
+  \a sampleRate.
+*/
+PluckedString::PluckedString(int sampleRate, double minimumFrequency)
+    : m_sampleRate(sampleRate),
+      m_delayLine((size_t)ceil(sampleRate / minimumFrequency) + 1, 0.0f),
+      m_length(1),
+      m_position(0),
+      m_loopGain(1),
+      m_allpassCoefficient(0),
+      m_allpassInput(0),
+      m_allpassOutput(0),
+      m_previous(0),
+      m_noise(1),
+      m_frequency(0)
+{
+    assert(sampleRate > 0 && minimumFrequency > 0);
+    setFrequency(minimumFrequency);
+}
+
+
+/*!
+  Returns the frequency of the string.
+*/
+double PluckedString::frequency() const
+{
+    return m_frequency;
+}
+
+
+/*!
+  Tunes the string to \a frequency. The string keeps ringing; call pluck()
+  to excite it at the new frequency.
+*/
+void PluckedString::setFrequency(double frequency)
+{
+    assert(frequency > 0 && frequency < m_sampleRate / 2.0);
+
+    // The loop delay is the delay line, half a sample of the average and the
+    // allpass delay between MinimumAllpassDelay and one more sample.
+    const double period = double(m_sampleRate) / frequency;
+    int length = (int)floor(period - 0.5 - MinimumAllpassDelay);
+    length = length < 1 ? 1 : length;
+    length = length > (int)m_delayLine.size() ? (int)m_delayLine.size()
+                                              : length;
+    const double delay = period - 0.5 - length;
+
+    // The coefficient giving exactly the delay at the frequency, rather than
+    // the usual (1 - delay) / (1 + delay) which is exact only at DC.
+    const double omega = 2.0 * M_PI * frequency / m_sampleRate;
+
+    m_frequency = frequency;
+    m_length = length;
+    m_position %= m_length;
+    m_allpassCoefficient = float(sin(omega * (1.0 - delay) / 2)
+                                 / sin(omega * (1.0 + delay) / 2));
+    m_loopGain = float(pow(0.001, 1.0 / (DecaySeconds * frequency)));
+}
+
+
+/*!
+  Plucks the string, replacing what is ringing with a new burst of noise.
+*/
+void PluckedString::pluck()
+{
+    float *line = &m_delayLine[0];
+    float smoothed(0);
+    double sum(0);
+
+    for (int i = 0; i < m_length; ++i) {
+        // A linear congruential generator, the upper bits scaled to -1..1.
+        m_noise = m_noise * 1664525u + 1013904223u;
+        const float noise = float(int32_t(m_noise)) * (1.0f / 2147483648.0f);
+
+        // Softens the pluck, like plucking with a finger rather than a pick,
+        // so that the fundamental is not buried under the harmonics.
+        smoothed += PluckSoftness * (noise - smoothed);
+        line[i] = smoothed;
+        sum += line[i];
+    }
+
+    // Removes the offset, which would otherwise ring as DC.
+    const float mean = float(sum / m_length);
+
+    for (int i = 0; i < m_length; ++i) {
+        line[i] -= mean;
+    }
+
+    m_position = 0;
+    m_previous = 0;
+    m_allpassInput = 0;
+    m_allpassOutput = 0;
+}
+
+
+/*!
+  Renders \a sampleCount samples of the string to \a block.
+*/
+void PluckedString::render(float *block, int sampleCount)
+{
+    float *line = &m_delayLine[0];
+    const int length = m_length;
+    const float gain = 0.5f * m_loopGain;
+    const float coefficient = m_allpassCoefficient;
+    float allpassInput = m_allpassInput;
+    float allpassOutput = m_allpassOutput;
+    float previous = m_previous;
+    int position = m_position;
+
+    for (int i = 0; i < sampleCount; ++i) {
+        const float current = line[position];
+        const float average = gain * (current + previous);
+        allpassOutput = coefficient * (average - allpassOutput)
+                + allpassInput;
+        allpassInput = average;
+        line[position] = allpassOutput;
+        previous = current;
+        block[i] = current;
+        position = position + 1 < length ? position + 1 : 0;
+    }
+
+    m_allpassInput = allpassInput;
+    m_allpassOutput = allpassOutput;
+    m_previous = previous;
+    m_position = position;
+}
@@ -0,0 +1,37 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef PLUCKEDSTRING_H
+#define PLUCKEDSTRING_H
+
+#include <stdint.h>
+#include <vector>
+
+
+class PluckedString
+{
+public:
+    PluckedString(int sampleRate, double minimumFrequency);
+
+public:
+    double frequency() const;
+    void setFrequency(double frequency);
+    void pluck();
+    void render(float *block, int sampleCount);
+
+private:
+    const int m_sampleRate;
+    std::vector<float> m_delayLine; // Allocated for the lowest frequency
+    int m_length; // The part of m_delayLine in use
+    int m_position; // In m_delayLine
+    float m_loopGain; // Per round trip
+    float m_allpassCoefficient;
+    float m_allpassInput; // The previous input of the allpass filter
+    float m_allpassOutput; // The previous output of the allpass filter
+    float m_previous; // The previous sample read from the delay line
+    uint32_t m_noise; // State of the excitation noise
+    double m_frequency;
+};
+
+#endif // PLUCKEDSTRING_H
@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "powergovernor.h"
+
+// The analysis interval is doubled after each this many seconds of stable
+// or silent readings.
+const static double BackOffSeconds(2.0);
+
+// The longest analysis interval in frames.
+const static int MaximumInterval(8);
+
+
+/*!
+  \class PowerGovernor
+  \brief Duty cycles the analysis when there is nothing new to measure.
+
+  Tells which of the completed frames are analyzed. While the readings
+  change every frame is analyzed. Once they have been stable or silent for
+  a while, the interval between the analyzed frames is doubled at a time
+  up to MaximumInterval frames. The full rate is restored as soon as the
+  reading changes, or at once with wake(), e.g. on an onset.
+*/
+
+
+/*!
+  Constructor. The governor is disabled, i.e. every frame is analyzed.
+*/
+PowerGovernor::PowerGovernor()
+    : m_isEnabled(false),
+      m_activity(Changing),
+      m_idleTime(0),
+      m_interval(1),
+      m_skipRemaining(0)
+{
+}
+
+
+/*!
+  Returns true if the analysis is duty cycled.
+*/
+bool PowerGovernor::isEnabled() const
+{
+    return m_isEnabled;
+}
+
+
+/*!
+  Enables the duty cycling if \a enabled is true. Restores the full rate.
+*/
+void PowerGovernor::setEnabled(bool enabled)
+{
+    m_isEnabled = enabled;
+    reset();
+}
+
+
+/*!
+  Restores the full rate and forgets the activity.
+*/
+void PowerGovernor::reset()
+{
+    m_activity = Changing;
+    wake();
+}
+
+
+/*!
+  Restores the full rate. The next frame is analyzed.
+*/
+void PowerGovernor::wake()
+{
+    m_idleTime = 0;
+    m_interval = 1;
+    m_skipRemaining = 0;
+}
+
+
+/*!
+  Called when a frame is complete. Returns true if the frame is to be
+  analyzed, false if it is to be skipped.
+*/
+bool PowerGovernor::takeFrame()
+{
+    if (m_skipRemaining > 0) {
+        --m_skipRemaining;
+        return false;
+    }
+
+    m_skipRemaining = m_interval - 1;
+    return true;
+}
+
+
+/*!
+  Updates the governor with the \a activity of an analyzed frame of
+  \a frameDuration seconds. The frames skipped before it count as the same
+  activity.
+*/
+void PowerGovernor::update(Activity activity, double frameDuration)
+{
+    m_activity = activity;
+
+    if (!m_isEnabled || activity == Changing) {
+        wake();
+        return;
+    }
+
+    m_idleTime += m_interval * frameDuration;
+
+    if (m_idleTime >= BackOffSeconds && m_interval < MaximumInterval) {
+        m_idleTime = 0;
+        m_interval *= 2;
+    }
+}
+
+
+/*!
+  Returns the activity of the last analyzed frame.
+*/
+PowerGovernor::Activity PowerGovernor::activity() const
+{
+    return m_activity;
+}
+
+
+/*!
+  Returns the number of frames from one analyzed frame to the next.
+*/
+int PowerGovernor::interval() const
+{
+    return m_interval;
+}
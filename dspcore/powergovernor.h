@@ -0,0 +1,39 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef POWERGOVERNOR_H
+#define POWERGOVERNOR_H
+
+
+class PowerGovernor
+{
+public:
+    enum Activity {
+        Changing = 0, // The reading is moving, analyze every frame
+        Stable, // The reading has settled
+        Silent // Nothing to measure
+    };
+
+public:
+    PowerGovernor();
+
+public:
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+    void reset();
+    void wake();
+    bool takeFrame();
+    void update(Activity activity, double frameDuration);
+    Activity activity() const;
+    int interval() const;
+
+private:
+    bool m_isEnabled;
+    Activity m_activity;
+    double m_idleTime; // Seconds the activity has been other than Changing
+    int m_interval; // Analyze every m_interval frame
+    int m_skipRemaining; // Frames to skip before the next analyzed one
+};
+
+#endif // POWERGOVERNOR_H
@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "spectrumbuffer.h"
+
+// Set in m_middle when the spectrum in between has not been taken yet.
+const static int FreshFlag(4);
+const static int IndexMask(3);
+
+
+/*!
+  \class Spectrum
+  \brief A snapshot of one analyzed frame for visualization.
+*/
+
+
+/*!
+  Constructor.
+*/
+Spectrum::Spectrum()
+    : firstFrequency(0),
+      binWidth(0),
+      peakFrequency(0),
+      streamPosition(0)
+{
+}
+
+
+/*!
+  \class SpectrumBuffer
+  \brief Passes spectra from the analysis to a view without locking.
+
+  A triple buffer: the writer fills back() and publishes it, the reader
+  takes the latest published spectrum with takeLatest(). The two sides
+  only swap indexes atomically, so neither ever waits for the other, and
+  a slow reader just skips the spectra published in between. There may be
+  one writer and one reader, on different threads. The vectors of the
+  spectra keep their capacity, so that publishing does not allocate once
+  the sizes have settled.
+*/
+
+
+/*!
+  Constructor.
+*/
+SpectrumBuffer::SpectrumBuffer()
+    : m_middle(1),
+      m_back(0),
+      m_front(2)
+{
+}
+
+
+/*!
+  Returns the spectrum to be filled by the writer.
+*/
+Spectrum &SpectrumBuffer::back()
+{
+    return m_spectra[m_back];
+}
+
+
+/*!
+  Publishes the spectrum filled by the writer. The writer gets another one
+  to fill.
+*/
+void SpectrumBuffer::publish()
+{
+    m_back = m_middle.exchange(m_back | FreshFlag, std::memory_order_acq_rel)
+            & IndexMask;
+}
+
+
+/*!
+  Takes the latest published spectrum to the reader. Returns 0 if nothing
+  was published since the last call. The spectrum stays valid until the
+  next call.
+*/
+const Spectrum *SpectrumBuffer::takeLatest()
+{
+    if (!(m_middle.load(std::memory_order_acquire) & FreshFlag)) {
+        return 0;
+    }
+
+    m_front = m_middle.exchange(m_front, std::memory_order_acq_rel)
+            & IndexMask;
+    return &m_spectra[m_front];
+}
+
+
+/*!
+  Returns the spectrum last taken by the reader, or an empty one.
+*/
+const Spectrum &SpectrumBuffer::front() const
+{
+    return m_spectra[m_front];
+}
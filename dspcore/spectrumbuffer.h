@@ -0,0 +1,49 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef SPECTRUMBUFFER_H
+#define SPECTRUMBUFFER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+
+struct Spectrum
+{
+    Spectrum();
+
+    std::vector<float> densities; // Squared densities of the analyzed band
+    std::vector<float> waveform; // Samples of the frame, from -1 to 1
+    double firstFrequency; // Frequency of densities[0] in Hz
+    double binWidth; // Hz from one density to the next
+    double peakFrequency; // Detected peak in Hz, or 0 if none
+    int64_t streamPosition; // End of the frame in the stream
+};
+
+
+class SpectrumBuffer
+{
+public:
+    SpectrumBuffer();
+
+public:
+    Spectrum &back();
+    void publish();
+    const Spectrum *takeLatest();
+    const Spectrum &front() const;
+
+private:
+    // Not copyable
+    SpectrumBuffer(const SpectrumBuffer &);
+    SpectrumBuffer &operator=(const SpectrumBuffer &);
+
+private:
+    Spectrum m_spectra[3];
+    std::atomic<int> m_middle; // Index of the spectrum in between, and a flag
+    int m_back; // Index of the spectrum written, owned by the writer
+    int m_front; // Index of the spectrum read, owned by the reader
+};
+
+#endif // SPECTRUMBUFFER_H
@@ -0,0 +1,13 @@
+# Copyright (c) 2012 Nokia Corporation.
+#
+# Compares the fixed point FFT with fftpack. Build it both ways, with and
+# without qmake CONFIG+=fixed_point, to check the peak search of each.
+
+TEMPLATE = app
+TARGET = tst_fixedpoint
+CONFIG += console testcase
+CONFIG -= qt app_bundle
+
+include(../../dspcore.pri)
+
+SOURCES += tst_fixedpoint.cpp
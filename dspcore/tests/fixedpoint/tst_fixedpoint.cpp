@@ -0,0 +1,295 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "analysisplan.h"
+#include "fastfouriertransformer.h"
+#include "fixedfouriertransformer.h"
+#include "tuning.h"
+
+// Defined by fastfouriertransformer.cpp, which compiles fftpack.c, in both
+// the floating and the fixed point builds.
+void __ogg_fdrffti(int n, float *wsave, int *ifac);
+void __ogg_fdrfftf(int n, float *r, float *wsave, int *ifac);
+
+// The magnitudes of the fixed point transformation are within this fraction
+// of the largest one of the exact ones, i.e. -80 dB. They agree with those of
+// fftpack within this and the error of fftpack itself, which is larger for
+// the lengths with a large prime factor, e.g. 538 = 2 * 269.
+const static double MagnitudeTolerance(1e-4);
+
+// The interpolated peaks agree within this many bins.
+const static double OffsetTolerance(1e-3);
+
+// As in PitchAnalyzer.
+const static int PrecisionPerNote(4);
+const static int MaximumOctaveRange(4);
+
+// Other lengths the transformation supports: odd ones, and ones with prime
+// factors other than 2, 3 and 5.
+const static int OtherSizes[] = { 539, 1215, 2025, 2 * 269, 4 * 7 * 11 };
+
+// Peak amplitudes of the test tones, from a loud to a quiet one.
+const static double Amplitudes[] = { 30000, 3000, 100 };
+
+
+/*!
+  Calculates the FFT of \a wave with fftpack, in the order of
+  FastFourierTransformer.
+*/
+static std::vector<float> referenceTransform(const std::vector<int16_t> &wave)
+{
+    const int n = (int)wave.size();
+    std::vector<float> data(wave.begin(), wave.end());
+    std::vector<float> workingArray(2 * n + 15);
+    std::vector<int> ifac(n);
+
+    __ogg_fdrffti(n, &workingArray[0], &ifac[0]);
+    __ogg_fdrfftf(n, &data[0], &workingArray[0], &ifac[0]);
+    return data;
+}
+
+
+/*!
+  Returns the magnitudes of the exact DFT of \a wave, in double precision,
+  of the indexes from 0 to \a last.
+*/
+static std::vector<double> exactMagnitudes(const std::vector<int16_t> &wave,
+                                           int last)
+{
+    const int n = (int)wave.size();
+    std::vector<double> cosines(n);
+    std::vector<double> sines(n);
+
+    for (int t = 0; t < n; ++t) {
+        cosines[t] = cos(2 * M_PI * t / n);
+        sines[t] = sin(2 * M_PI * t / n);
+    }
+
+    std::vector<double> magnitudes(last + 1);
+
+    for (int k = 0; k <= last; ++k) {
+        double re = 0;
+        double im = 0;
+
+        for (int i = 0, t = 0; i < n; ++i, t = (t + k) % n) {
+            re += wave[i] * cosines[t];
+            im -= wave[i] * sines[t];
+        }
+
+        magnitudes[k] = hypot(re, im);
+    }
+
+    return magnitudes;
+}
+
+
+/*!
+  Returns the magnitude of the index \a k of the coefficients \a c.
+*/
+template <typename T>
+static double magnitude(const T *c, int k, int exponent = 0)
+{
+    return hypot(ldexp(double(c[2 * k - 1]), exponent),
+                 ldexp(double(c[2 * k]), exponent));
+}
+
+
+/*!
+  Returns the interpolated peak of the reference coefficients \a c at the
+  index \a index, like FastFourierTransformer::getPeakOffset().
+*/
+static double referenceOffset(const std::vector<float> &c, int index)
+{
+    const int n = (int)c.size();
+
+    if (index < 2 || index >= n / 2 - 1) {
+        return 0;
+    }
+
+    const double numeratorRe = c[2 * index - 3] - c[2 * index + 1];
+    const double numeratorIm = c[2 * index - 2] - c[2 * index + 2];
+    const double denominatorRe =
+            2 * c[2 * index - 1] - c[2 * index - 3] - c[2 * index + 1];
+    const double denominatorIm =
+            2 * c[2 * index] - c[2 * index - 2] - c[2 * index + 2];
+    const double ratio = (numeratorRe * denominatorRe
+                          + numeratorIm * denominatorIm)
+            / (denominatorRe * denominatorRe + denominatorIm * denominatorIm);
+    const double binAngle = M_PI / n;
+    const double offset = atan(tan(binAngle) * ratio) / binAngle;
+    return std::max(-0.5, std::min(0.5, offset));
+}
+
+
+/*!
+  Returns the frame sizes of the plans of PitchAnalyzer, for each string
+  and all the strings of every preset, and the other supported sizes.
+*/
+static std::set<int> frameSizes()
+{
+    std::set<int> sizes(OtherSizes, OtherSizes
+                        + sizeof(OtherSizes) / sizeof(OtherSizes[0]));
+    const int rates[] = { 44100, 48000 };
+    const std::vector<std::string> names = Tuning::presetNames();
+
+    for (int r = 0; r < 2; ++r) {
+        PcmFormat format;
+        format.sampleRate = rates[r];
+        format.channels = 1;
+        format.sampleSize = 16;
+        format.sampleType = PcmFormat::SignedInt;
+        format.byteOrder = PcmFormat::LittleEndian;
+
+        for (size_t i = 0; i < names.size(); ++i) {
+            const Tuning tuning = Tuning::preset(names[i]);
+            std::vector<double> frequencies;
+            std::vector<int> strings;
+
+            for (int s = 0; s < tuning.stringCount(); ++s) {
+                const double frequency = tuning.string(s).targetFrequency();
+                const AnalysisPlan plan(format,
+                                        std::vector<double>(1, frequency),
+                                        std::vector<int>(1, s),
+                                        PrecisionPerNote, MaximumOctaveRange);
+                sizes.insert(plan.totalSampleCount());
+                frequencies.push_back(frequency);
+                strings.push_back(s);
+            }
+
+            const AnalysisPlan plan(format, frequencies, strings,
+                                    PrecisionPerNote, MaximumOctaveRange);
+            sizes.insert(plan.totalSampleCount());
+        }
+    }
+
+    return sizes;
+}
+
+
+/*!
+  Returns a tone at \a bin of the length \a n with its second harmonic and
+  some noise, with the peak amplitude \a amplitude.
+*/
+static std::vector<int16_t> tone(int n, double bin, double amplitude)
+{
+    std::vector<int16_t> wave(n);
+
+    for (int i = 0; i < n; ++i) {
+        const double phase = 2 * M_PI * bin * i / n;
+        const double noise = (rand() % 2001) / 1000.0 - 1;
+        const double value = amplitude * (0.7 * sin(phase + 0.3)
+                                          + 0.25 * sin(2 * phase)
+                                          + 0.05 * noise);
+        wave[i] = int16_t(lrint(value));
+    }
+
+    return wave;
+}
+
+
+/*!
+  Checks the transformations of the length \a n. Returns the number of
+  failed checks.
+*/
+static int checkSize(int n)
+{
+    const int last = (n + 1) / 2 - 1;
+    int failures = 0;
+    double worst = 0;
+
+    for (size_t a = 0; a < sizeof(Amplitudes) / sizeof(Amplitudes[0]); ++a) {
+        // Below the half of the spectrum, so that the harmonic fits in.
+        const double bin = 3 + (rand() % 1000) / 1000.0 * (n / 4 - 6);
+        const std::vector<int16_t> wave = tone(n, bin, Amplitudes[a]);
+        const std::vector<float> reference = referenceTransform(wave);
+        const std::vector<double> exact = exactMagnitudes(wave, last);
+
+        FixedFourierTransformer fixed;
+        std::vector<int32_t> coefficients(n);
+        const int exponent = fixed.transform(&wave[0], n, &coefficients[0]);
+
+        double largest = 0;
+        double error = 0; // Of the fixed point from the exact magnitudes
+        double referenceError = 0; // Of fftpack from the exact magnitudes
+        double difference = 0; // Between the fixed point and fftpack
+        int index = 1;
+
+        for (int k = 1; k <= last; ++k) {
+            const double value = magnitude(&reference[0], k);
+            const double fixedValue =
+                    magnitude(&coefficients[0], k, exponent);
+            error = std::max(error, fabs(fixedValue - exact[k]));
+            referenceError = std::max(referenceError, fabs(value - exact[k]));
+            difference = std::max(difference, fabs(fixedValue - value));
+
+            if (value > largest) {
+                largest = value;
+                index = k;
+            }
+        }
+
+        worst = std::max(worst, difference / largest);
+
+        if (error > MagnitudeTolerance * largest
+                || difference > MagnitudeTolerance * largest + referenceError) {
+            printf("FAIL: size %d, amplitude %g: magnitude error %.3g, from "
+                   "fftpack %.3g, fftpack error %.3g of the largest\n", n,
+                   Amplitudes[a], error / largest, difference / largest,
+                   referenceError / largest);
+            failures++;
+        }
+
+        // The peak search of this build, fixed or floating point.
+        FastFourierTransformer fft;
+        fft.reserve(n);
+        fft.calculateFFT(&wave[0], n);
+        const int peak = fft.getMaximumDensityIndex(1, last);
+        const double offset = fft.getPeakOffset(peak);
+        const double expected = referenceOffset(reference, index);
+
+        if (peak != index || fabs(offset - expected) > OffsetTolerance) {
+            printf("FAIL: size %d, amplitude %g: peak %d%+.4f, expected "
+                   "%d%+.4f\n", n, Amplitudes[a], peak, offset, index,
+                   expected);
+            failures++;
+        }
+    }
+
+    printf("%s: size %d, worst magnitude difference from fftpack %.1f dB\n",
+           failures ? "FAIL" : "PASS", n, 20 * log10(worst));
+    return failures;
+}
+
+
+int main()
+{
+#ifdef DSPCORE_FIXED_POINT
+    printf("Peak search in fixed point\n");
+#else
+    printf("Peak search in floating point\n");
+#endif
+
+    srand(1);
+    const std::set<int> sizes = frameSizes();
+    int failures = 0;
+
+    for (std::set<int>::const_iterator i = sizes.begin(); i != sizes.end();
+         ++i) {
+        failures += checkSize(*i);
+    }
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,12 @@
+# Copyright (c) 2012 Nokia Corporation.
+#
+# Checks that exact target sines read in tune on every string.
+
+TEMPLATE = app
+TARGET = tst_pitchaccuracy
+CONFIG += console testcase
+CONFIG -= qt app_bundle
+
+include(../../dspcore.pri)
+
+SOURCES += tst_pitchaccuracy.cpp
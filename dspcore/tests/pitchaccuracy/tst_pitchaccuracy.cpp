@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "pitchanalyzer.h"
+
+// A sine exactly at the target reads in tune within this many cents.
+const static double ToleranceCents(1.0);
+
+// Seconds of the sine fed to the analyzer.
+const static double DurationSeconds(5.0);
+
+const static int SampleRate(48000);
+const static int WriteSize(960); // Sample frames per write
+const static double Amplitude(10000);
+
+
+/*!
+  Keeps the latest result of the analyzer.
+*/
+class LatestResult : public PitchAnalyzerListener
+{
+public:
+    LatestResult() : m_count(0) {}
+
+    void pitchAnalyzed(const PitchResult &result)
+    {
+        m_result = result;
+        m_count++;
+    }
+
+    const PitchResult &result() const { return m_result; }
+    int count() const { return m_count; }
+
+private:
+    PitchResult m_result;
+    int m_count;
+};
+
+
+/*!
+  Feeds a sine of \a frequency to \a analyzer.
+*/
+static void writeSine(PitchAnalyzer *analyzer, double frequency)
+{
+    std::vector<int16_t> buffer(WriteSize);
+    const int writes = int(DurationSeconds * SampleRate / WriteSize);
+    int64_t t = 0;
+
+    for (int i = 0; i < writes; ++i) {
+        for (size_t j = 0; j < buffer.size(); ++j, ++t) {
+            buffer[j] = int16_t(lrint(Amplitude
+                                      * sin(2 * M_PI * frequency * t
+                                            / SampleRate)));
+        }
+
+        analyzer->write(reinterpret_cast<const char *>(&buffer[0]),
+                        int64_t(buffer.size() * sizeof(int16_t)));
+    }
+}
+
+
+/*!
+  Checks that the target sine of each string of the standard tuning reads
+  in tune, with the string selected and in the auto mode. Returns the
+  number of failed checks.
+*/
+static int checkStandardTuning()
+{
+    PcmFormat format;
+    format.sampleRate = SampleRate;
+    format.channels = 1;
+    format.sampleSize = 16;
+    format.sampleType = PcmFormat::SignedInt;
+    format.byteOrder = PcmFormat::LittleEndian;
+
+    const Tuning tuning = Tuning::preset("standard");
+    int failures = 0;
+
+    for (int autoMode = 0; autoMode < 2; ++autoMode) {
+        for (int string = 0; string < tuning.stringCount(); ++string) {
+            PitchAnalyzer analyzer(format);
+            LatestResult listener;
+            analyzer.setListener(&listener);
+            analyzer.setTuning(tuning);
+
+            if (autoMode) {
+                analyzer.setAutoModeEnabled(true);
+            }
+            else {
+                analyzer.setString(string);
+            }
+
+            const double frequency = tuning.string(string).targetFrequency();
+            writeSine(&analyzer, frequency);
+
+            const PitchResult &result = listener.result();
+            const double cents = result.smoothedVoiceDifference * 100;
+            const bool isPassed = listener.count() > 0 && !result.isLowVoice
+                    && result.stringIndex == string
+                    && fabs(cents) <= ToleranceCents;
+
+            printf("%s: %s string %d, %.2f Hz reads %+.2f cents\n",
+                   isPassed ? "PASS" : "FAIL", autoMode ? "auto" : "selected",
+                   string, frequency, cents);
+
+            if (!isPassed) {
+                failures++;
+            }
+        }
+    }
+
+    return failures;
+}
+
+
+int main()
+{
+    const int failures = checkStandardTuning();
+
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
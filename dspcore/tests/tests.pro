@@ -0,0 +1,10 @@
+# Copyright (c) 2012 Nokia Corporation.
+#
+# Tests of the signal processing core. Plain C++ programs, which print the
+# failed checks and exit with a non-zero status: run them with make check.
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    fixedpoint \
+    pitchaccuracy
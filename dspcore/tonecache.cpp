@@ -0,0 +1,151 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "tonecache.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include "wavetable.h"
+
+// A loop holds the fewest whole periods that fit in a whole number of
+// samples with the frequency off by at most LoopToleranceCents. The loops
+// are kept at most MaximumLoopSamples long, 16 kB, so that the loop being
+// played stays in the L1 cache; if no number of periods fits within the
+// tolerance, the closest fit in that length is used.
+const static double LoopToleranceCents(0.1);
+const static int MaximumLoopSamples(4096);
+
+
+/*!
+  \class ToneLoop
+  \brief A pre-rendered reference tone of a whole number of periods, which
+         can be played in a loop without a seam.
+*/
+
+
+/*!
+  Constructor.
+*/
+ToneLoop::ToneLoop()
+    : sampleCount(0),
+      periods(0),
+      frequency(0)
+{
+}
+
+
+/*!
+  \class ToneCache
+  \brief Read-only set of the reference tones of the strings of a tuning.
+
+  The tones are rendered once, when the cache is made, at the sample rate of
+  the output device and at unit amplitude, so that playing them costs only
+  applying the gain and converting to the format. Each tone is read from a
+  Wavetable of the harmonics, band-limited for its frequency. Each loop holds the
+  smallest whole number of periods that fits in a whole number of samples
+  within a tenth of a cent: the frequency of the loop is tuned to the
+  frequency for which the periods fit exactly. For the strings of a guitar
+  the loops are from a few hundred to a few thousand samples long.
+*/
+
+
+/*!
+  Constructor. Renders the loops of \a frequencies with \a harmonics, see
+  Wavetable, at the sample rate of \a format.
+*/
+ToneCache::ToneCache(const PcmFormat &format,
+                     const std::vector<double> &frequencies,
+                     const std::vector<double> &harmonics)
+    : m_format(format)
+{
+    assert(m_format.isValid());
+
+    m_loops.resize(frequencies.size());
+
+    for (size_t i = 0; i < frequencies.size(); ++i) {
+        render(&m_loops[i], frequencies[i], harmonics);
+    }
+}
+
+
+/*!
+  Returns the format of the loops.
+*/
+const PcmFormat &ToneCache::format() const
+{
+    return m_format;
+}
+
+
+/*!
+  Returns the number of loops.
+*/
+int ToneCache::loopCount() const
+{
+    return (int)m_loops.size();
+}
+
+
+/*!
+  Returns the loop at \a index.
+*/
+const ToneLoop &ToneCache::loop(int index) const
+{
+    assert(index >= 0 && index < loopCount());
+    return m_loops[index];
+}
+
+
+/*!
+  Renders the voice of \a frequency with \a harmonics to \a loop.
+*/
+void ToneCache::render(ToneLoop *loop, double frequency,
+                       const std::vector<double> &harmonics)
+{
+    assert(frequency > 0 && frequency < m_format.sampleRate / 2.0);
+
+    const double samplesPerPeriod = m_format.sampleRate / frequency;
+    const double tolerance = pow(2.0, LoopToleranceCents / 1200) - 1;
+    int periods(1);
+    double bestError(HUGE_VAL);
+
+    // At least one period is always taken, even if it does not fit in the
+    // maximum length.
+    for (int candidate = 1; ; ++candidate) {
+        const double exactCount = candidate * samplesPerPeriod;
+        const double candidateCount = floor(exactCount + 0.5);
+
+        if (candidate > 1 && candidateCount > MaximumLoopSamples) {
+            break;
+        }
+
+        const double error = fabs(candidateCount - exactCount) / exactCount;
+
+        if (error < bestError) {
+            bestError = error;
+            periods = candidate;
+        }
+
+        if (error <= tolerance) {
+            break;
+        }
+    }
+
+    const int sampleCount = (int)lround(periods * samplesPerPeriod);
+
+    loop->periods = periods;
+    loop->sampleCount = sampleCount;
+    loop->frequency = double(periods) * m_format.sampleRate / sampleCount;
+    loop->samples.resize(sampleCount);
+
+    const Wavetable table(harmonics,
+                          Wavetable::harmonicLimit(loop->frequency,
+                                                   m_format.sampleRate));
+
+    for (int i = 0; i < sampleCount; ++i) {
+        loop->samples[i] = table.valueAt(
+                    double(int64_t(periods) * i % sampleCount) / sampleCount);
+    }
+}
@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef TONECACHE_H
+#define TONECACHE_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "pcmformat.h"
+
+
+struct ToneLoop
+{
+    ToneLoop();
+
+    std::vector<float> samples; // Whole periods, at unit amplitude
+    int sampleCount;
+    int periods; // Number of periods in the loop
+    double frequency; // Exact frequency of the loop
+};
+
+
+class ToneCache
+{
+public:
+    ToneCache(const PcmFormat &format,
+              const std::vector<double> &frequencies,
+              const std::vector<double> &harmonics);
+
+public:
+    const PcmFormat &format() const;
+    int loopCount() const;
+    const ToneLoop &loop(int index) const;
+
+private:
+    void render(ToneLoop *loop, double frequency,
+                const std::vector<double> &harmonics);
+
+private:
+    // Not copyable
+    ToneCache(const ToneCache &);
+    ToneCache &operator=(const ToneCache &);
+
+private:
+    const PcmFormat m_format;
+    std::vector<ToneLoop> m_loops;
+};
+
+#endif // TONECACHE_H
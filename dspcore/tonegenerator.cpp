@@ -0,0 +1,725 @@
+/**
+ * Copyright (c) 2011-2012 Nokia Corporation.
+ */
+
+#include "tonegenerator.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+// The amount of data the generator claims to have available. The data is
+// generated on demand, so there is always more.
+const int BufferSizeMilliseconds(100);
+
+// The upper bits of the phase index the wavetable and the rest interpolate
+// between the entries. With linear interpolation the error of a sine in the
+// table is about 1e-6, i.e. under the resolution of 16-bit samples.
+const int PhaseFractionBits(32 - Wavetable::Bits);
+const float PhaseFractionScale(1.0f / (1 << PhaseFractionBits));
+const double FullCircle(4294967296.0); // 2^32
+
+// The voice is rendered in blocks of this many samples before applying the
+// gain and converting them to the format.
+const int BlockSamples(256);
+
+
+/*!
+  Adds \a sampleCount \a samples multiplied by \a gain to \a mix. The loop
+  has no dependencies between the samples, so the compiler vectorizes it.
+*/
+static inline void accumulate(float *mix, const float *samples, float gain,
+                              int sampleCount)
+{
+    for (int i = 0; i < sampleCount; ++i) {
+        mix[i] += gain * samples[i];
+    }
+}
+
+// A change of the amplitude is ramped linearly over this time, which is
+// long enough not to click and short enough to follow a slider.
+const int GainRampMilliseconds(20);
+
+// The plucked voice is plucked again with this interval, so that the tone
+// does not die away. The lowest frequency it can be tuned to is also set.
+const int PluckIntervalMilliseconds(2500);
+const double MinimumPluckedFrequency(20.0);
+
+// The notes of a chord range this many octaves from their strings, e.g. a
+// bass octave below or the doublings of the high strings.
+const int MaximumChordOctaves(3);
+
+
+/*!
+  \class ToneGenerator
+  \brief Generates PCM data of a sine or a plucked voice with the set
+         frequency and amplitude.
+
+  The generator has no dependencies to Qt; the data is pulled with read().
+
+  The strings of the tuning given by setTuning() are played from loops
+  pre-rendered to a ToneCache, so that selecting a string with setString()
+  only swaps the loop being copied. Any other frequency set by
+  setFrequency() is generated on demand with a phase accumulator reading a
+  Wavetable made for the frequency, with linear interpolation between the
+  entries.
+
+  The voice is a sine by default. With setHarmonics() it is made of the
+  given harmonics, band-limited below the Nyquist frequency, at the same
+  cost per sample.
+
+  The phase runs continuously, also when switching between the loops and
+  the oscillator, so a new frequency takes effect at the next sample without
+  a jump in the waveform.
+
+  With setVoice() the sine can be replaced by a PluckedString, tuned exactly
+  to the frequency of the string or to the set frequency. The string is
+  plucked when it is tuned, when pluck() is called and then periodically.
+
+  With setChord() any subset of the strings of the tuning sounds at once,
+  each with its own gain, or any list of notes of the strings: a string may
+  sound several times, and in the octaves above or below it. The loops of
+  the notes, or their plucked strings, are accumulated to a mix one note at
+  a time, so that the cost grows linearly with the number of notes and
+  there is no branching per sample.
+
+  The voice is rendered at unit amplitude and the amplitude is applied as a
+  gain when reading, before PcmWriter converts the samples to the format. A
+  new amplitude set by setAmplitude() is reached with a short linear ramp,
+  so that changing it neither clicks nor renders anything again.
+*/
+
+
+/*!
+  \struct ToneGenerator::ChordNote
+  \brief A note of a chord, the \a string of the tuning with \a gain,
+         \a octave octaves above it, or below it if negative.
+*/
+
+
+/*!
+  Constructor.
+*/
+ToneGenerator::ChordNote::ChordNote(int string, double gain, int octave)
+    : string(string),
+      gain(gain),
+      octave(octave)
+{
+}
+
+
+/*!
+  Constructor.
+*/
+ToneGenerator::ToneGenerator(const PcmFormat &format,
+                             double frequency,
+                             double amplitude)
+    : m_format(format),
+      m_writer(format),
+      m_harmonics(1, 1.0),
+      m_block(BlockSamples),
+      m_loop(0),
+      m_string(-1),
+      m_loopPosition(0),
+      m_phase(0),
+      m_phaseIncrement(0),
+      m_amplitude(amplitude),
+      m_gain((float)amplitude),
+      m_gainStep(0),
+      m_gainRampRemaining(0),
+      m_voice(SineVoice),
+      m_pluckedString(format.sampleRate, MinimumPluckedFrequency),
+      m_pluckCountdown(0),
+      m_voiceBlock(BlockSamples),
+      m_frequency(0)
+{
+    assert(m_format.isValid());
+    assert(amplitude >= 0);
+    setFrequency(frequency);
+}
+
+
+/*!
+  Rewinds the generator to the beginning of the voice. A pending gain ramp
+  is completed at once, and the plucked voice is plucked again.
+*/
+void ToneGenerator::reset()
+{
+    m_phase = 0;
+    m_loopPosition = 0;
+
+    for (size_t i = 0; i < m_chordVoices.size(); ++i) {
+        m_chordVoices[i].position = 0;
+    }
+
+    m_pluckCountdown = 0;
+    m_gain = (float)m_amplitude;
+    m_gainRampRemaining = 0;
+}
+
+
+/*!
+  Puts \a length amount of voice data into \a data array. Returns the amount
+  of data read, which is \a length rounded down to whole samples.
+*/
+int64_t ToneGenerator::read(char *data, int64_t length)
+{
+    const int frameBytes = m_format.bytesPerFrame();
+    const int64_t sampleCount = length / frameBytes;
+    unsigned char *ptr = reinterpret_cast<unsigned char *>(data);
+    float *block = &m_block[0];
+    int64_t total(0);
+
+    while (total < sampleCount) {
+        const int count = (int)std::min<int64_t>(BlockSamples,
+                                                 sampleCount - total);
+
+        if (m_voice == PluckedVoice) {
+            renderPlucked(block, count);
+        }
+        else if (!m_chordNotes.empty()) {
+            mixChord(block, count);
+        }
+        else if (m_loop) {
+            renderLoop(block, count);
+        }
+        else {
+            renderOscillator(block, count);
+        }
+
+        applyGain(block, count);
+        m_writer.write(ptr, block, count);
+        ptr += count * frameBytes;
+        total += count;
+    }
+
+    return total * frameBytes;
+}
+
+
+/*!
+  Copies \a sampleCount samples of the loop to \a block.
+*/
+void ToneGenerator::renderLoop(float *block, int sampleCount)
+{
+    const float *loop = &m_loop->samples[0];
+    int total(0);
+
+    while (total < sampleCount) {
+        const int chunk = (int)std::min<int64_t>(
+                    sampleCount - total, m_loop->sampleCount - m_loopPosition);
+        memcpy(block + total, loop + m_loopPosition, chunk * sizeof(float));
+        m_loopPosition = (m_loopPosition + chunk) % m_loop->sampleCount;
+        total += chunk;
+    }
+}
+
+
+/*!
+  Generates \a sampleCount samples of the oscillator to \a block.
+*/
+void ToneGenerator::renderOscillator(float *block, int sampleCount)
+{
+    const float *table = m_wavetable->values();
+
+    for (int i = 0; i < sampleCount; ++i) {
+        const int index = m_phase >> PhaseFractionBits;
+        const float fraction = (m_phase & ((1 << PhaseFractionBits) - 1))
+                * PhaseFractionScale;
+        const float left = table[index];
+        block[i] = left + fraction * (table[index + 1] - left);
+
+        // Wraps around at the full circle.
+        m_phase += m_phaseIncrement;
+    }
+}
+
+
+/*!
+  Renders \a sampleCount samples of the plucked string, or the plucked
+  strings of the chord, to \a block, plucking them when the countdown runs
+  out.
+*/
+void ToneGenerator::renderPlucked(float *block, int sampleCount)
+{
+    const bool isChord = !m_chordNotes.empty();
+    int total(0);
+
+    while (total < sampleCount) {
+        if (m_pluckCountdown == 0) {
+            if (isChord) {
+                for (size_t i = 0; i < m_chordStrings.size(); ++i) {
+                    m_chordStrings[i].pluck();
+                }
+            }
+            else {
+                m_pluckedString.pluck();
+            }
+
+            m_pluckCountdown = std::max(1, m_format.sampleRate
+                                        * PluckIntervalMilliseconds / 1000);
+        }
+
+        const int chunk = std::min(sampleCount - total, m_pluckCountdown);
+
+        if (isChord) {
+            mixPluckedChord(block + total, chunk);
+        }
+        else {
+            m_pluckedString.render(block + total, chunk);
+        }
+
+        m_pluckCountdown -= chunk;
+        total += chunk;
+    }
+}
+
+
+/*!
+  Mixes \a sampleCount samples of the loops of the chord to \a block. The
+  loops are read in place, in chunks up to their ends.
+*/
+void ToneGenerator::mixChord(float *block, int sampleCount)
+{
+    std::fill(block, block + sampleCount, 0.0f);
+
+    for (size_t i = 0; i < m_chordVoices.size(); ++i) {
+        ChordVoice &voice = m_chordVoices[i];
+        const float *loop = &voice.loop->samples[0];
+        int total(0);
+
+        while (total < sampleCount) {
+            const int chunk = std::min(sampleCount - total,
+                                       voice.loop->sampleCount - voice.position);
+            accumulate(block + total, loop + voice.position, voice.gain, chunk);
+            voice.position = (voice.position + chunk) % voice.loop->sampleCount;
+            total += chunk;
+        }
+    }
+}
+
+
+/*!
+  Mixes \a sampleCount samples of the plucked strings of the chord to
+  \a block, at most BlockSamples.
+*/
+void ToneGenerator::mixPluckedChord(float *block, int sampleCount)
+{
+    float *voiceBlock = &m_voiceBlock[0];
+    std::fill(block, block + sampleCount, 0.0f);
+
+    for (size_t i = 0; i < m_chordStrings.size(); ++i) {
+        m_chordStrings[i].render(voiceBlock, sampleCount);
+        accumulate(block, voiceBlock, m_chordVoices[i].gain, sampleCount);
+    }
+}
+
+
+/*!
+  Multiplies the \a sampleCount samples of \a block by the gain, advancing
+  the gain ramp if one is running. Both loops are free of dependencies
+  between the samples, so the compiler vectorizes them.
+*/
+void ToneGenerator::applyGain(float *block, int sampleCount)
+{
+    int i(0);
+
+    if (m_gainRampRemaining > 0) {
+        const int rampCount = std::min(sampleCount, m_gainRampRemaining);
+        const float gain = m_gain;
+        const float step = m_gainStep;
+
+        for (; i < rampCount; ++i) {
+            block[i] *= gain + step * float(i + 1);
+        }
+
+        m_gainRampRemaining -= rampCount;
+
+        // The end of the ramp lands exactly on the amplitude.
+        m_gain = m_gainRampRemaining > 0
+                ? gain + step * float(rampCount) : (float)m_amplitude;
+    }
+
+    const float gain = m_gain;
+
+    for (; i < sampleCount; ++i) {
+        block[i] *= gain;
+    }
+}
+
+
+/*!
+  Returns the number of bytes which can be read at once.
+*/
+int64_t ToneGenerator::bytesAvailable() const
+{
+    return int64_t(m_format.sampleRate) * BufferSizeMilliseconds / 1000
+            * m_format.bytesPerFrame();
+}
+
+
+/*!
+  Returns the format of the generated data.
+*/
+const PcmFormat &ToneGenerator::format() const
+{
+    return m_format;
+}
+
+
+/*!
+  Returns the current frequency.
+*/
+double ToneGenerator::frequency() const
+{
+    return m_voice == PluckedVoice ? m_pluckedString.frequency() : m_frequency;
+}
+
+
+/*!
+  Sets the frequency to \a frequency, generated by the oscillator. The phase
+  continues from where it is.
+*/
+void ToneGenerator::setFrequency(double frequency)
+{
+    assert(frequency > 0 && frequency < m_format.sampleRate / 2.0);
+
+    const double phase = this->phase();
+    m_loop = 0;
+    m_string = -1;
+    m_frequency = frequency;
+    m_phaseIncrement = (uint32_t)llround(frequency / m_format.sampleRate
+                                         * FullCircle);
+    setPhase(phase);
+    updateWavetable();
+    tunePluckedString();
+}
+
+
+/*!
+  Renders the loops of the strings of \a frequencies. If a string is
+  selected, the string with the same index is selected from the new loops,
+  or the first string if there is no such string.
+*/
+void ToneGenerator::setTuning(const std::vector<double> &frequencies)
+{
+    assert(!frequencies.empty());
+
+    // The previous loop is released with the previous cache.
+    const double phase = this->phase();
+    m_stringFrequencies = frequencies;
+    m_cache = std::make_shared<ToneCache>(m_format, frequencies, m_harmonics);
+
+    if (!m_chordNotes.empty()) {
+        // The notes of the strings missing from the new tuning are left out.
+        setUpChord();
+    }
+
+    if (m_string >= 0) {
+        m_string = m_string < m_cache->loopCount() ? m_string : 0;
+        m_loop = &m_cache->loop(m_string);
+        m_frequency = m_loop->frequency;
+        setPhase(phase);
+        tunePluckedString();
+    }
+}
+
+
+/*!
+  Returns the index of the selected string, or -1 if the frequency is not
+  one of the strings.
+*/
+int ToneGenerator::string() const
+{
+    return m_string;
+}
+
+
+/*!
+  Selects the string at \a string, played from its pre-rendered loop. The
+  phase continues from where it is.
+*/
+void ToneGenerator::setString(int string)
+{
+    assert(m_cache && string >= 0 && string < m_cache->loopCount());
+
+    const double phase = this->phase();
+    m_loop = &m_cache->loop(string);
+    m_string = string;
+    m_frequency = m_loop->frequency;
+    setPhase(phase);
+    tunePluckedString();
+}
+
+
+/*!
+  Returns the amplitude being ramped to.
+*/
+double ToneGenerator::amplitude() const
+{
+    return m_amplitude;
+}
+
+
+/*!
+  Sets the amplitude for the voice to \a amplitude. The gain is ramped from
+  where it is to the new amplitude over the following samples read.
+*/
+void ToneGenerator::setAmplitude(double amplitude)
+{
+    assert(amplitude >= 0);
+
+    if (amplitude == m_amplitude) {
+        return;
+    }
+
+    m_amplitude = amplitude;
+    m_gainRampRemaining = std::max(1, m_format.sampleRate
+                                   * GainRampMilliseconds / 1000);
+    m_gainStep = float((amplitude - m_gain) / m_gainRampRemaining);
+}
+
+
+/*!
+  Returns the amplitudes of the harmonics of the voice, from the
+  fundamental.
+*/
+const std::vector<double> &ToneGenerator::harmonics() const
+{
+    return m_harmonics;
+}
+
+
+/*!
+  Sets the amplitudes of the harmonics of the voice to \a harmonics, from the
+  fundamental, e.g. { 1, 0.5, 0.33 }. The waveform is scaled to the peak of
+  one. The loops of the tuning are rendered again with the harmonics. Has
+  no effect on the plucked voice.
+*/
+void ToneGenerator::setHarmonics(const std::vector<double> &harmonics)
+{
+    assert(!harmonics.empty());
+
+    m_harmonics = harmonics;
+    m_wavetable.reset();
+    updateWavetable();
+
+    if (m_cache) {
+        setTuning(m_stringFrequencies);
+    }
+}
+
+
+/*!
+  Returns the notes of the chord, or an empty vector if no chord is set.
+*/
+const std::vector<ToneGenerator::ChordNote> &ToneGenerator::chord() const
+{
+    return m_chordNotes;
+}
+
+
+/*!
+  Plays the chord of the strings of the tuning with \a gains, one per
+  string in the order of the tuning. The strings with a zero gain, or
+  without a gain, are left out. An empty \a gains ends the chord.
+*/
+void ToneGenerator::setChord(const std::vector<double> &gains)
+{
+    std::vector<ChordNote> notes;
+
+    for (size_t i = 0; i < gains.size(); ++i) {
+        if (gains[i] != 0) {
+            notes.push_back(ChordNote((int)i, gains[i]));
+        }
+    }
+
+    setChord(notes);
+}
+
+
+/*!
+  Plays the chord of \a notes, which may repeat the strings of the tuning
+  and double them up to MaximumChordOctaves octaves above or below. The
+  notes with a zero gain, or of a string missing from the tuning or an
+  octave out of the range, are left out. The mix is scaled down if the
+  gains sum to more than one, so that a full chord does not clip. An empty
+  \a notes ends the chord, and the selected string or frequency is played
+  again.
+
+  The notes start from the beginning of their periods, and the plucked
+  voice is plucked. The memory for the notes, and the loops of the octaves,
+  are allocated here, none when reading.
+*/
+void ToneGenerator::setChord(const std::vector<ChordNote> &notes)
+{
+    assert(notes.empty() || m_cache);
+
+    m_chordNotes = notes;
+    setUpChord();
+}
+
+
+/*!
+  Makes the voices of the notes of the chord which sound, their loops from
+  the cache, or rendered for the octaves, and their plucked strings.
+*/
+void ToneGenerator::setUpChord()
+{
+    m_chordVoices.clear();
+    m_chordStrings.clear();
+    m_chordCache.reset();
+
+    std::vector<ChordNote> notes;
+    std::vector<double> octaveFrequencies;
+    double sum(0);
+
+    for (size_t i = 0; i < m_chordNotes.size(); ++i) {
+        const ChordNote &note = m_chordNotes[i];
+
+        if (note.gain == 0 || note.string < 0
+                || note.string >= (int)m_stringFrequencies.size()
+                || abs(note.octave) > MaximumChordOctaves) {
+            continue;
+        }
+
+        const double frequency = ldexp(m_stringFrequencies[note.string],
+                                       note.octave);
+
+        if (frequency < MinimumPluckedFrequency
+                || frequency >= m_format.sampleRate / 2.0) {
+            continue;
+        }
+
+        if (note.octave != 0) {
+            octaveFrequencies.push_back(frequency);
+        }
+
+        notes.push_back(note);
+        sum += fabs(note.gain);
+    }
+
+    if (!octaveFrequencies.empty()) {
+        m_chordCache.reset(new ToneCache(m_format, octaveFrequencies,
+                                         m_harmonics));
+    }
+
+    const double headroom = 1.0 / std::max(1.0, sum);
+    int octaveIndex(0);
+
+    for (size_t i = 0; i < notes.size(); ++i) {
+        ChordVoice voice;
+        voice.loop = notes[i].octave == 0
+                ? &m_cache->loop(notes[i].string)
+                : &m_chordCache->loop(octaveIndex++);
+        voice.position = 0;
+        voice.gain = float(notes[i].gain * headroom);
+        m_chordVoices.push_back(voice);
+
+        PluckedString string(m_format.sampleRate, MinimumPluckedFrequency);
+        string.setFrequency(ldexp(m_stringFrequencies[notes[i].string],
+                                  notes[i].octave));
+        m_chordStrings.push_back(string);
+    }
+
+    m_pluckCountdown = 0;
+}
+
+
+/*!
+  Returns the voice being generated.
+*/
+ToneGenerator::Voice ToneGenerator::voice() const
+{
+    return m_voice;
+}
+
+
+/*!
+  Sets the voice to \a voice. The plucked voice starts with a pluck.
+*/
+void ToneGenerator::setVoice(Voice voice)
+{
+    if (voice == m_voice) {
+        return;
+    }
+
+    m_voice = voice;
+    m_pluckCountdown = 0;
+}
+
+
+/*!
+  Plucks the plucked voice again at the next sample read. Has no effect on
+  the sine voice.
+*/
+void ToneGenerator::pluck()
+{
+    m_pluckCountdown = 0;
+}
+
+
+/*!
+  Tunes the plucked string exactly to the frequency of the selected string,
+  or to the set frequency, and plucks it if the frequency changed. The sine
+  voice plays the loops, which can be off by a fraction of a cent.
+*/
+void ToneGenerator::tunePluckedString()
+{
+    const double frequency = m_string >= 0 ? m_stringFrequencies[m_string]
+                                           : m_frequency;
+
+    if (frequency != m_pluckedString.frequency()) {
+        m_pluckedString.setFrequency(frequency);
+        m_pluckCountdown = 0;
+    }
+}
+
+
+/*!
+  Returns the phase of the voice, between 0 and 1 periods.
+*/
+double ToneGenerator::phase() const
+{
+    if (m_loop) {
+        return double(m_loopPosition * m_loop->periods % m_loop->sampleCount)
+                / m_loop->sampleCount;
+    }
+
+    return m_phase / FullCircle;
+}
+
+
+/*!
+  Sets the phase of the voice to \a phase, between 0 and 1 periods.
+*/
+void ToneGenerator::setPhase(double phase)
+{
+    if (m_loop) {
+        // The position in the first period with the phase.
+        m_loopPosition = llround(phase * m_loop->sampleCount / m_loop->periods)
+                % m_loop->sampleCount;
+    }
+    else {
+        m_phase = (uint32_t)llround(phase * FullCircle);
+    }
+}
+
+
+/*!
+  Makes the wavetable of the oscillator for the harmonics below the Nyquist
+  frequency at the current frequency, unless the current table has them
+  already.
+*/
+void ToneGenerator::updateWavetable()
+{
+    const int harmonicCount = std::min(
+                (int)m_harmonics.size(),
+                Wavetable::harmonicLimit(m_frequency, m_format.sampleRate));
+
+    if (!m_wavetable || m_wavetable->harmonicCount() != harmonicCount) {
+        m_wavetable.reset(new Wavetable(m_harmonics, harmonicCount));
+    }
+}
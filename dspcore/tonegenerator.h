@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef TONEGENERATOR_H
+#define TONEGENERATOR_H
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "pcmformat.h"
+#include "pcmwriter.h"
+#include "pluckedstring.h"
+#include "tonecache.h"
+#include "wavetable.h"
+
+
+class ToneGenerator
+{
+public:
+    enum Voice {
+        SineVoice = 0,
+        PluckedVoice
+    };
+
+    // A voice of the chord: a string of the tuning, or its octave above or
+    // below, with a gain.
+    struct ChordNote
+    {
+        ChordNote(int string = 0, double gain = 1.0, int octave = 0);
+
+        int string; // Index in the tuning
+        double gain;
+        int octave; // Octaves from the string, e.g. 1 for the octave above
+    };
+
+public:
+    ToneGenerator(const PcmFormat &format, double frequency, double amplitude);
+
+public:
+    void reset();
+    int64_t read(char *data, int64_t length);
+    int64_t bytesAvailable() const;
+    const PcmFormat &format() const;
+    double frequency() const;
+    void setFrequency(double frequency);
+    void setTuning(const std::vector<double> &frequencies);
+    int string() const;
+    void setString(int string);
+    const std::vector<ChordNote> &chord() const;
+    void setChord(const std::vector<double> &gains);
+    void setChord(const std::vector<ChordNote> &notes);
+    double amplitude() const;
+    void setAmplitude(double amplitude);
+    const std::vector<double> &harmonics() const;
+    void setHarmonics(const std::vector<double> &harmonics);
+    Voice voice() const;
+    void setVoice(Voice voice);
+    void pluck();
+
+private:
+    double phase() const;
+    void setPhase(double phase);
+    void renderLoop(float *block, int sampleCount);
+    void renderOscillator(float *block, int sampleCount);
+    void renderPlucked(float *block, int sampleCount);
+    void mixChord(float *block, int sampleCount);
+    void mixPluckedChord(float *block, int sampleCount);
+    void setUpChord();
+    void tunePluckedString();
+    void updateWavetable();
+    void applyGain(float *block, int sampleCount);
+
+private:
+    // A note sounding in the chord
+    struct ChordVoice
+    {
+        const ToneLoop *loop;
+        int position; // In the loop
+        float gain; // Scaled for the headroom of the chord
+    };
+
+private:
+    // Not copyable
+    ToneGenerator(const ToneGenerator &);
+    ToneGenerator &operator=(const ToneGenerator &);
+
+private:
+    const PcmFormat m_format;
+    const PcmWriter m_writer;
+    std::vector<double> m_harmonics; // Amplitudes, from the fundamental
+    std::unique_ptr<const Wavetable> m_wavetable; // For the oscillator
+    std::vector<float> m_block; // The samples being read, before the format
+    std::vector<double> m_stringFrequencies; // Of the tuning
+    std::shared_ptr<const ToneCache> m_cache; // Loops of the strings
+    const ToneLoop *m_loop; // The loop being played, or null
+    int m_string; // Index of m_loop in m_cache, or -1
+    int64_t m_loopPosition; // In samples
+    uint32_t m_phase; // Full circle is 2^32
+    uint32_t m_phaseIncrement; // Per sample
+    double m_amplitude; // The gain being ramped to
+    float m_gain; // The gain of the last sample read
+    float m_gainStep; // Per sample, while ramping
+    int m_gainRampRemaining; // In samples
+    Voice m_voice;
+    PluckedString m_pluckedString;
+    int m_pluckCountdown; // Samples to the next pluck
+    std::vector<ChordNote> m_chordNotes; // Empty if no chord
+    std::unique_ptr<const ToneCache> m_chordCache; // Octaves of the chord
+    std::vector<ChordVoice> m_chordVoices; // The notes which sound
+    std::vector<PluckedString> m_chordStrings; // Parallel to m_chordVoices
+    std::vector<float> m_voiceBlock; // A plucked string of the chord
+    double m_frequency;
+};
+
+#endif // TONEGENERATOR_H
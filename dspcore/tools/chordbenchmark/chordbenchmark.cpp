@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+#include "tonegenerator.h"
+#include "tuning.h"
+
+// The chords measured, up to this many notes.
+const static int MaximumNotes(24);
+
+// Each chord is read for this many seconds of output, in reads of
+// ReadMilliseconds like the output device pulls them.
+const static double MeasuredSeconds(20.0);
+const static int ReadMilliseconds(10);
+
+const static int SampleRate(48000);
+
+
+/*!
+  Returns a chord of \a count notes of the strings of \a tuning: each
+  string in turn, doubled an octave below, above and two above as the
+  notes run through the strings again.
+*/
+static std::vector<ToneGenerator::ChordNote> chord(const Tuning &tuning,
+                                                   int count)
+{
+    std::vector<ToneGenerator::ChordNote> notes;
+
+    for (int i = 0; i < count; ++i) {
+        const int round = i / tuning.stringCount();
+        const int octave = (round == 0) ? 0 : (round == 1 ? -1 : round - 1);
+        notes.push_back(ToneGenerator::ChordNote(i % tuning.stringCount(),
+                                                 1.0, octave));
+    }
+
+    return notes;
+}
+
+
+/*!
+  Returns the seconds taken to read MeasuredSeconds of \a generator.
+*/
+static double measure(ToneGenerator *generator)
+{
+    const PcmFormat &format = generator->format();
+    std::vector<char> buffer(format.bytesPerFrame() * format.sampleRate
+                             * ReadMilliseconds / 1000);
+    const int reads = int(MeasuredSeconds * 1000 / ReadMilliseconds);
+
+    const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+
+    for (int i = 0; i < reads; ++i) {
+        generator->read(&buffer[0], (int64_t)buffer.size());
+    }
+
+    return std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+}
+
+
+/*!
+  Prints the cost of the chords of 1 to MaximumNotes notes, for the loops
+  of the strings and the plucked strings, and the cost of each note added
+  to the first. The chord replaces the selected string, whose cost is
+  printed for comparison.
+*/
+int main()
+{
+    PcmFormat format;
+    format.sampleRate = SampleRate;
+    format.channels = 2;
+    format.sampleSize = 16;
+    format.sampleType = PcmFormat::SignedInt;
+    format.byteOrder = PcmFormat::LittleEndian;
+
+    const Tuning tuning = Tuning::preset("standard");
+    const ToneGenerator::Voice voices[] = { ToneGenerator::SineVoice,
+                                            ToneGenerator::PluckedVoice };
+    const char *voiceNames[] = { "loops", "plucked" };
+
+    printf("Microseconds per second of %d Hz stereo output\n", SampleRate);
+
+    for (int v = 0; v < 2; ++v) {
+        ToneGenerator generator(format, 100, 0.5);
+        generator.setTuning(tuning.targetFrequencies());
+        generator.setString(0);
+        generator.setVoice(voices[v]);
+
+        const double base = measure(&generator) / MeasuredSeconds;
+        printf("%s, selected string: %.1f\n", voiceNames[v], base * 1e6);
+
+        generator.setChord(chord(tuning, 1));
+        const double first = measure(&generator) / MeasuredSeconds;
+        printf("%s,  1 note:  %6.1f\n", voiceNames[v], first * 1e6);
+
+        for (int count = 2; count <= MaximumNotes; ++count) {
+            generator.setChord(chord(tuning, count));
+            const double cost = measure(&generator) / MeasuredSeconds;
+            printf("%s, %2d notes: %6.1f, %5.1f per added note\n",
+                   voiceNames[v], count, cost * 1e6,
+                   (cost - first) * 1e6 / (count - 1));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,12 @@
+# Copyright (c) 2012 Nokia Corporation.
+#
+# Measures the cost of mixing a chord per voice.
+
+TEMPLATE = app
+TARGET = chordbenchmark
+CONFIG += console
+CONFIG -= qt app_bundle
+
+include(../../dspcore.pri)
+
+SOURCES += chordbenchmark.cpp
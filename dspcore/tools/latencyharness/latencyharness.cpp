@@ -0,0 +1,297 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "pitchanalyzer.h"
+#include "pluckedstring.h"
+
+// The capture period sizes measured by default, in sample frames: from the
+// default buffer of a device to the smallest periods usually granted.
+const static int DefaultPeriods[] = { 4800, 2048, 960, 480, 256 };
+
+const static int SampleRate(48000);
+const static double MeasuredSeconds(60.0);
+const static double Amplitude(12000);
+
+// A string rings for PluckSeconds and is then silent for GapSeconds, so
+// that each pluck is a new onset.
+const static double PluckSeconds(1.0);
+const static double GapSeconds(0.3);
+
+// The pitch of a sustained tone steps by StepSemitones every StepSeconds.
+// A reading within ReadingSemitones of the new pitch, half a bin of the
+// analysis, is the first one of the step.
+const static double StepSemitones(1.0);
+const static double StepSeconds(0.7);
+const static double ReadingSemitones(0.25);
+
+// Sample frames added to the intervals between the events, so that the
+// events fall on all the phases of the capture periods.
+const static int EventDrift(131);
+
+const static int String(1); // The A string of the standard tuning
+
+
+/*!
+  Records when \a analyzer reports a reading after an event. The time of
+  a reading is the end of the write which produced it, i.e. when the
+  capture period holding the event has been delivered and analyzed. A
+  pluck is read by the first reading of a frame started at its onset, not
+  by one of a frame which started before it.
+*/
+class LatencyProbe : public PitchAnalyzerListener
+{
+public:
+    explicit LatencyProbe(const PitchAnalyzer *analyzer)
+        : m_analyzer(analyzer),
+          m_onsetsMeasured(0),
+          m_eventPosition(-1),
+          m_writeEnd(0),
+          m_target(0),
+          m_isStep(false),
+          m_total(0),
+          m_count(0)
+    {
+    }
+
+    // Marks an event at the sample frame \a position. A step is read by a
+    // reading near \a target semitones.
+    void markEvent(int64_t position, bool isStep, double target)
+    {
+        m_eventPosition = position;
+        m_isStep = isStep;
+        m_target = target;
+    }
+
+    void setWriteEnd(int64_t position)
+    {
+        m_writeEnd = position;
+    }
+
+    void pitchAnalyzed(const PitchResult &result)
+    {
+        const int64_t onsetsMeasured =
+                m_analyzer->statistics().onsetsMeasured;
+        const bool isOnsetRead = onsetsMeasured > m_onsetsMeasured;
+        m_onsetsMeasured = onsetsMeasured;
+
+        if (result.isLowVoice || m_eventPosition < 0) {
+            return;
+        }
+
+        if (m_isStep
+                ? fabs(result.voiceDifference - m_target) > ReadingSemitones
+                : !isOnsetRead) {
+            return;
+        }
+
+        m_total += double(m_writeEnd - m_eventPosition) / SampleRate;
+        m_count++;
+        m_eventPosition = -1;
+    }
+
+    // Returns the average latency in milliseconds, or 0 if nothing read.
+    double averageMilliseconds() const
+    {
+        return m_count > 0 ? 1000 * m_total / m_count : 0;
+    }
+
+    int count() const { return m_count; }
+
+private:
+    const PitchAnalyzer *m_analyzer;
+    int64_t m_onsetsMeasured; // By the analyzer so far
+    int64_t m_eventPosition; // Of the event not read yet, or -1
+    int64_t m_writeEnd;
+    double m_target;
+    bool m_isStep;
+    double m_total;
+    int m_count;
+};
+
+
+/*!
+  Returns the number of plucks written in MeasuredSeconds.
+*/
+static int pluckCount()
+{
+    const int64_t cycleLength =
+            int64_t((PluckSeconds + GapSeconds) * SampleRate) + EventDrift;
+    return int((int64_t(MeasuredSeconds * SampleRate) + cycleLength - 1)
+               / cycleLength);
+}
+
+
+/*!
+  Returns the analyzer of the A string of the standard tuning, told that
+  it is written \a period sample frames at a time if \a isPeriodKnown.
+*/
+static PitchAnalyzer *createAnalyzer(int period, bool isPeriodKnown)
+{
+    PcmFormat format;
+    format.sampleRate = SampleRate;
+    format.channels = 1;
+    format.sampleSize = 16;
+    format.sampleType = PcmFormat::SignedInt;
+    format.byteOrder = PcmFormat::LittleEndian;
+
+    PitchAnalyzer *analyzer = new PitchAnalyzer(format);
+    analyzer->setTuning(Tuning::preset("standard"));
+    analyzer->setString(String);
+
+    if (isPeriodKnown) {
+        analyzer->setCapturePeriod(period);
+    }
+
+    return analyzer;
+}
+
+
+/*!
+  Writes plucks of the string to the analyzer in periods of \a period
+  sample frames. Returns the average latency from a pluck to its first
+  reading in milliseconds, the number of plucks read to \a count and the
+  number of onsets the analyzer detected to \a onsets.
+*/
+static double measurePlucks(int period, bool isPeriodKnown, int *count,
+                            int *onsets)
+{
+    PitchAnalyzer *analyzer = createAnalyzer(period, isPeriodKnown);
+    LatencyProbe probe(analyzer);
+    analyzer->setListener(&probe);
+
+    const double frequency =
+            Tuning::preset("standard").string(String).targetFrequency();
+    PluckedString string(SampleRate, frequency);
+    string.setFrequency(frequency);
+
+    const int64_t pluckLength = int64_t(PluckSeconds * SampleRate);
+    const int64_t cycleLength =
+            int64_t((PluckSeconds + GapSeconds) * SampleRate) + EventDrift;
+    const int64_t totalLength = int64_t(MeasuredSeconds * SampleRate);
+    std::vector<float> block(period);
+    std::vector<int16_t> buffer(period);
+    int64_t position = 0;
+
+    while (position + period <= totalLength) {
+        string.render(&block[0], period);
+
+        for (int i = 0; i < period; ++i, ++position) {
+            const int64_t phase = position % cycleLength;
+
+            if (phase == 0) {
+                string.pluck();
+                probe.markEvent(position, false, 0);
+            }
+
+            const double value = phase < pluckLength ? block[i] : 0;
+            buffer[i] = int16_t(lrint(Amplitude * value));
+        }
+
+        probe.setWriteEnd(position);
+        analyzer->write(reinterpret_cast<const char *>(&buffer[0]),
+                        int64_t(period * sizeof(int16_t)));
+    }
+
+    *onsets = (int)analyzer->statistics().onsetsDetected;
+    delete analyzer;
+    *count = probe.count();
+    return probe.averageMilliseconds();
+}
+
+
+/*!
+  Writes a sustained tone of the string, stepping its pitch up and down,
+  to the analyzer in periods of \a period sample frames. Returns the
+  average latency from a step to the first reading of the new pitch in
+  milliseconds, and the number of steps read to \a count.
+*/
+static double measureSteps(int period, bool isPeriodKnown, int *count)
+{
+    PitchAnalyzer *analyzer = createAnalyzer(period, isPeriodKnown);
+    LatencyProbe probe(analyzer);
+    analyzer->setListener(&probe);
+
+    const double frequency =
+            Tuning::preset("standard").string(String).targetFrequency();
+    const int64_t stepLength = int64_t(StepSeconds * SampleRate) + EventDrift;
+    const int64_t totalLength = int64_t(MeasuredSeconds * SampleRate);
+    std::vector<int16_t> buffer(period);
+    int64_t position = 0;
+    double semitones = 0;
+    double phase = 0;
+
+    while (position + period <= totalLength) {
+        for (int i = 0; i < period; ++i, ++position) {
+            if (position > 0 && position % stepLength == 0) {
+                semitones = (semitones == 0) ? StepSemitones : 0;
+                probe.markEvent(position, true, semitones);
+            }
+
+            phase += 2 * M_PI * frequency * pow(2.0, semitones / 12)
+                    / SampleRate;
+            buffer[i] = int16_t(lrint(Amplitude * sin(phase)));
+        }
+
+        probe.setWriteEnd(position);
+        analyzer->write(reinterpret_cast<const char *>(&buffer[0]),
+                        int64_t(period * sizeof(int16_t)));
+    }
+
+    delete analyzer;
+    *count = probe.count();
+    return probe.averageMilliseconds();
+}
+
+
+/*!
+  Prints the latencies for the capture period sizes given as the arguments,
+  or DefaultPeriods, with the analyzer scheduling its frames for the period
+  and without.
+*/
+int main(int argc, char *argv[])
+{
+    std::vector<int> periods;
+
+    for (int i = 1; i < argc; ++i) {
+        const int period = atoi(argv[i]);
+
+        if (period <= 0) {
+            fprintf(stderr, "Usage: %s [period size in frames]...\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        periods.push_back(period);
+    }
+
+    if (periods.empty()) {
+        periods.assign(DefaultPeriods, DefaultPeriods
+                       + sizeof(DefaultPeriods) / sizeof(DefaultPeriods[0]));
+    }
+
+    printf("Latency to the first reading at %d Hz, in milliseconds\n",
+           SampleRate);
+    printf("period  scheduled  pluck (read/onsets/plucks)  step (read)\n");
+
+    for (size_t i = 0; i < periods.size(); ++i) {
+        for (int known = 0; known < 2; ++known) {
+            int plucks(0);
+            int onsets(0);
+            int steps(0);
+            const double pluck =
+                    measurePlucks(periods[i], known, &plucks, &onsets);
+            const double step = measureSteps(periods[i], known, &steps);
+            printf("%6d  %-9s  %5.1f (%3d/%3d/%3d)         %5.1f (%3d)\n",
+                   periods[i], known ? "yes" : "no", pluck, plucks, onsets,
+                   pluckCount(), step, steps);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
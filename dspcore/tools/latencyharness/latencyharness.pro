@@ -0,0 +1,13 @@
+# Copyright (c) 2012 Nokia Corporation.
+#
+# Measures the latency from a pluck or a change of the pitch to the reading
+# of PitchAnalyzer, for the capture period sizes a device may grant.
+
+TEMPLATE = app
+TARGET = latencyharness
+CONFIG += console
+CONFIG -= qt app_bundle
+
+include(../../dspcore.pri)
+
+SOURCES += latencyharness.cpp
@@ -0,0 +1,10 @@
+# Copyright (c) 2012 Nokia Corporation.
+#
+# Measurement tools of the signal processing core. Plain C++ programs which
+# print their measurements; they are not run by make check.
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    chordbenchmark \
+    latencyharness
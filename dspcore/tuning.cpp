@@ -0,0 +1,308 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "tuning.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+
+// Frequency of A4 and its note number; the other notes are equal tempered.
+// The notes are numbered in semitones from C0.
+const static double ConcertPitch(440.0);
+const static int ConcertPitchNote(57); // 12 * 4 + 9
+
+const static char *NoteNames[] = {
+    "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"
+};
+
+struct Preset
+{
+    const char *name;
+    // Null terminated, in the order of the strings on the instrument: from
+    // the lowest string, except for the re-entrant ukulele, whose fourth
+    // string G4 is above C4. Nothing depends on the strings being ascending.
+    const char *notes[9];
+};
+
+const static Preset Presets[] = {
+    { "standard", { "E2", "A2", "D3", "G3", "B3", "E4", 0 } },
+    { "dropD", { "D2", "A2", "D3", "G3", "B3", "E4", 0 } },
+    { "DADGAD", { "D2", "A2", "D3", "G3", "A3", "D4", 0 } },
+    { "sevenString", { "B1", "E2", "A2", "D3", "G3", "B3", "E4", 0 } },
+    { "eightString", { "F#1", "B1", "E2", "A2", "D3", "G3", "B3", "E4", 0 } },
+    { "bass4", { "E1", "A1", "D2", "G2", 0 } },
+    { "bass5", { "B0", "E1", "A1", "D2", "G2", 0 } },
+    { "ukulele", { "G4", "C4", "E4", "A4", 0 } }
+};
+
+const static int PresetCount(sizeof(Presets) / sizeof(Presets[0]));
+
+
+/*!
+  \class TuningString
+  \brief The name and the target frequency of one string of a tuning.
+*/
+
+
+/*!
+  Constructor.
+*/
+TuningString::TuningString()
+    : frequency(0),
+      centOffset(0)
+{
+}
+
+
+/*!
+  Constructor.
+*/
+TuningString::TuningString(const std::string &name, double frequency,
+                           double centOffset)
+    : name(name),
+      frequency(frequency),
+      centOffset(centOffset)
+{
+}
+
+
+/*!
+  Returns the nominal frequency shifted by the cent offset.
+*/
+double TuningString::targetFrequency() const
+{
+    return frequency * pow(2.0, centOffset / 1200);
+}
+
+
+/*!
+  \class Tuning
+  \brief A named set of strings of an instrument.
+
+  The presets cover the common guitar, bass and ukulele tunings. Custom
+  tunings can be made from note names, e.g. "F#1" or "Bb3", or from
+  frequencies, and each string can be offset by cents.
+*/
+
+
+/*!
+  Constructor. Creates an invalid tuning without strings.
+*/
+Tuning::Tuning()
+{
+}
+
+
+/*!
+  Constructor.
+*/
+Tuning::Tuning(const std::string &name, const std::vector<TuningString> &strings)
+    : m_name(name),
+      m_strings(strings)
+{
+}
+
+
+/*!
+  Returns true if the tuning has strings, all with a positive frequency.
+*/
+bool Tuning::isValid() const
+{
+    if (m_strings.empty()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < m_strings.size(); ++i) {
+        if (!(m_strings[i].targetFrequency() > 0)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*!
+  Returns the name of the tuning.
+*/
+const std::string &Tuning::name() const
+{
+    return m_name;
+}
+
+
+/*!
+  Returns the number of strings.
+*/
+int Tuning::stringCount() const
+{
+    return (int)m_strings.size();
+}
+
+
+/*!
+  Returns the string at \a index.
+*/
+const TuningString &Tuning::string(int index) const
+{
+    assert(index >= 0 && index < stringCount());
+    return m_strings[index];
+}
+
+
+/*!
+  Sets the offset of the string at \a index to \a centOffset cents.
+*/
+void Tuning::setCentOffset(int index, double centOffset)
+{
+    assert(index >= 0 && index < stringCount());
+    m_strings[index].centOffset = centOffset;
+}
+
+
+/*!
+  Returns the target frequencies of the strings.
+*/
+std::vector<double> Tuning::targetFrequencies() const
+{
+    std::vector<double> retval;
+
+    for (size_t i = 0; i < m_strings.size(); ++i) {
+        retval.push_back(m_strings[i].targetFrequency());
+    }
+
+    return retval;
+}
+
+
+/*!
+  Returns the names of the preset tunings.
+*/
+std::vector<std::string> Tuning::presetNames()
+{
+    std::vector<std::string> retval;
+
+    for (int i = 0; i < PresetCount; ++i) {
+        retval.push_back(Presets[i].name);
+    }
+
+    return retval;
+}
+
+
+/*!
+  Returns the preset tuning with \a name, or an invalid tuning if there is no
+  such preset.
+*/
+Tuning Tuning::preset(const std::string &name)
+{
+    for (int i = 0; i < PresetCount; ++i) {
+        if (name == Presets[i].name) {
+            std::vector<std::string> notes;
+
+            for (int j = 0; Presets[i].notes[j]; ++j) {
+                notes.push_back(Presets[i].notes[j]);
+            }
+
+            return fromNotes(name, notes);
+        }
+    }
+
+    return Tuning();
+}
+
+
+/*!
+  Returns a tuning with \a name whose strings are \a notes, or an invalid
+  tuning if a note can not be parsed.
+*/
+Tuning Tuning::fromNotes(const std::string &name,
+                         const std::vector<std::string> &notes)
+{
+    std::vector<TuningString> strings;
+
+    for (size_t i = 0; i < notes.size(); ++i) {
+        double frequency(0);
+
+        if (!noteToFrequency(notes[i], &frequency)) {
+            return Tuning();
+        }
+
+        strings.push_back(TuningString(notes[i], frequency));
+    }
+
+    return Tuning(name, strings);
+}
+
+
+/*!
+  Parses \a note, a letter from A to G, optionally followed by '#' or 'b',
+  followed by the octave, e.g. "E2", "F#1" or "Bb3". Stores the equal
+  tempered frequency of the note to \a frequency. Returns false if the note
+  can not be parsed.
+*/
+bool Tuning::noteToFrequency(const std::string &note, double *frequency)
+{
+    // Semitones of the letters from C
+    const static int Semitones[] = { 9, 11, 0, 2, 4, 5, 7 }; // A B C D E F G
+
+    if (note.size() < 2) {
+        return false;
+    }
+
+    const char letter = toupper(note[0]);
+
+    if (letter < 'A' || letter > 'G') {
+        return false;
+    }
+
+    int semitone = Semitones[letter - 'A'];
+    size_t i = 1;
+
+    if (note[i] == '#') {
+        semitone++;
+        i++;
+    }
+    else if (note[i] == 'b') {
+        semitone--;
+        i++;
+    }
+
+    if (i >= note.size()) {
+        return false;
+    }
+
+    char *end = 0;
+    const long octave = strtol(note.c_str() + i, &end, 10);
+
+    if (*end != '\0' || end == note.c_str() + i) {
+        return false;
+    }
+
+    *frequency = noteFrequency(int(octave) * 12 + semitone);
+    return true;
+}
+
+
+/*!
+  Returns the equal tempered frequency of \a note, the number of semitones
+  from C0.
+*/
+double Tuning::noteFrequency(int note)
+{
+    return ConcertPitch * pow(2.0, (note - ConcertPitchNote) / 12.0);
+}
+
+
+/*!
+  Returns the name of \a note, the number of semitones from C0, without the
+  octave, e.g. "F#". The octave is note / 12.
+*/
+std::string Tuning::noteName(int note)
+{
+    assert(note >= 0);
+    return NoteNames[note % 12];
+}
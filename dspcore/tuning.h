@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <string>
+#include <vector>
+
+
+struct TuningString
+{
+    TuningString();
+    TuningString(const std::string &name, double frequency,
+                 double centOffset = 0);
+
+    double targetFrequency() const;
+
+    std::string name; // E.g. "E2"
+    double frequency; // Nominal frequency in Hz
+    double centOffset; // Offset from the nominal frequency in cents
+};
+
+
+class Tuning
+{
+public:
+    Tuning();
+    Tuning(const std::string &name, const std::vector<TuningString> &strings);
+
+public:
+    bool isValid() const;
+    const std::string &name() const;
+    int stringCount() const;
+    const TuningString &string(int index) const;
+    void setCentOffset(int index, double centOffset);
+    std::vector<double> targetFrequencies() const;
+
+    static std::vector<std::string> presetNames();
+    static Tuning preset(const std::string &name);
+    static Tuning fromNotes(const std::string &name,
+                            const std::vector<std::string> &notes);
+    static bool noteToFrequency(const std::string &note, double *frequency);
+    static double noteFrequency(int note);
+    static std::string noteName(int note);
+
+private:
+    std::string m_name;
+    std::vector<TuningString> m_strings;
+};
+
+#endif // TUNING_H
@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "wavetable.h"
+
+#include <assert.h>
+#include <math.h>
+#include <algorithm>
+
+#include "fastfouriertransformer.h"
+
+
+/*!
+  \class Wavetable
+  \brief One period of a band-limited periodic waveform.
+
+  The waveform is the sum of the harmonics given as amplitudes, the first
+  being the fundamental, e.g. { 1 } for a sine or { 1, 0.5, 0.33, 0.25 }
+  for a string-like tone. The table is synthesized by filling the spectrum
+  and running one inverse FFT, and scaled to the peak of one.
+
+  Only the harmonics up to the limit given when making the table are
+  included, so that a table made for a frequency with harmonicLimit() has
+  no harmonics above the Nyquist frequency and does not alias. Reading the
+  table costs the same whatever the harmonics are.
+*/
+
+
+/*!
+  Constructor. Synthesizes the table of \a harmonics, leaving out the
+  harmonics above \a harmonicLimit.
+*/
+Wavetable::Wavetable(const std::vector<double> &harmonics, int harmonicLimit)
+    : m_values(Size + 1, 0.0f),
+      m_harmonicCount(std::min(std::min((int)harmonics.size(), harmonicLimit),
+                               (int)Size / 2 - 1))
+{
+    // The inverse real FFT gives the cosine of the real part and the negated
+    // sine of the imaginary part of the bin k at [2k - 1] and [2k], doubled.
+    for (int k = 1; k <= m_harmonicCount; ++k) {
+        m_values[2 * k] = float(-0.5 * harmonics[k - 1]);
+    }
+
+    FastFourierTransformer fft;
+    fft.calculateInverseFFT(&m_values[0], Size);
+
+    float peak(0);
+
+    for (int i = 0; i < Size; ++i) {
+        peak = std::max(peak, fabsf(m_values[i]));
+    }
+
+    if (peak > 0) {
+        for (int i = 0; i < Size; ++i) {
+            m_values[i] /= peak;
+        }
+    }
+
+    m_values[Size] = m_values[0];
+}
+
+
+/*!
+  Returns the Size + 1 values of the table. The last one equals the first.
+*/
+const float *Wavetable::values() const
+{
+    return &m_values[0];
+}
+
+
+/*!
+  Returns the number of harmonics in the table.
+*/
+int Wavetable::harmonicCount() const
+{
+    return m_harmonicCount;
+}
+
+
+/*!
+  Returns the value at \a phase, between 0 and 1 periods, interpolated
+  linearly between the entries.
+*/
+float Wavetable::valueAt(double phase) const
+{
+    const double position = (phase - floor(phase)) * Size;
+    const int index = std::min((int)position, Size - 1);
+    const float fraction = float(position - index);
+    return m_values[index]
+            + fraction * (m_values[index + 1] - m_values[index]);
+}
+
+
+/*!
+  Returns the number of the highest harmonic of \a frequency below the
+  Nyquist frequency of \a sampleRate.
+*/
+int Wavetable::harmonicLimit(double frequency, int sampleRate)
+{
+    assert(frequency > 0);
+    return std::max(1, (int)ceil(sampleRate / (2.0 * frequency)) - 1);
+}
@@ -0,0 +1,36 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef WAVETABLE_H
+#define WAVETABLE_H
+
+#include <vector>
+
+
+class Wavetable
+{
+public:
+    // The table has 2^Bits entries over a period, and one more for
+    // interpolating past the last entry.
+    enum {
+        Bits = 11,
+        Size = 1 << Bits
+    };
+
+public:
+    Wavetable(const std::vector<double> &harmonics, int harmonicLimit);
+
+public:
+    const float *values() const;
+    int harmonicCount() const;
+    float valueAt(double phase) const;
+
+    static int harmonicLimit(double frequency, int sampleRate);
+
+private:
+    std::vector<float> m_values;
+    int m_harmonicCount;
+};
+
+#endif // WAVETABLE_H
@@ -0,0 +1,35 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef AUDIOFORMATCONVERTER_H
+#define AUDIOFORMATCONVERTER_H
+
+#include <QtMultimediaKit/QAudioFormat>
+
+#include "pcmformat.h"
+
+
+/*!
+  Returns the PCM layout of \a format for the DSP core.
+*/
+inline PcmFormat toPcmFormat(const QAudioFormat &format)
+{
+    PcmFormat retval;
+    retval.sampleRate = format.sampleRate();
+    retval.channels = format.channels();
+    retval.sampleSize = format.sampleSize();
+
+    switch (format.sampleType()) {
+    case QAudioFormat::SignedInt: retval.sampleType = PcmFormat::SignedInt; break;
+    case QAudioFormat::UnSignedInt: retval.sampleType = PcmFormat::UnSignedInt; break;
+    case QAudioFormat::Float: retval.sampleType = PcmFormat::Float; break;
+    default: retval.sampleType = PcmFormat::Unknown; break;
+    }
+
+    retval.byteOrder = (format.byteOrder() == QAudioFormat::LittleEndian)
+            ? PcmFormat::LittleEndian : PcmFormat::BigEndian;
+    return retval;
+}
+
+#endif // AUDIOFORMATCONVERTER_H
@@ -4,24 +4,62 @@
 
 #include "guitartuner.h"
 
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThread>
 #include <QtCore/qmath.h>
+#include <QtCore/qnumeric.h>
 #include <QtMultimediaKit/QAudioDeviceInfo>
 #include <QtMultimediaKit/QAudioInput>
 #include <QtMultimediaKit/QAudioOutput>
+#include <QtQuick/QQuickWindow>
 
 #include "constants.h"
 #include "voiceanalyzer.h"
 #include "voicegenerator.h"
 
 // Constants
-const qreal StringInterval(2.5f);
 const QString IsInputKey("isInput");
 const QString IsMutedKey("isMuted");
 const QString AutoModeEnabledKey("autoModeEnabled");
+const QString ChromaticModeEnabledKey("chromaticModeEnabled");
 const QString SensitivityKey("sensitivity");
 const QString VolumeKey("volume");
 const QString StringKey("string");
+const QString TuningKey("tuning");
+const QString TuningStringsKey("tuningStrings");
+const QString VoiceKey("voice");
+const QString HarmonicsKey("harmonics");
+const QString ChordKey("chord");
+const QString GainKey("gain");
+const QString OctaveKey("octave");
+const QString TargetLatencyKey("targetLatency");
+const QString CaptureBufferSizeKey("captureBufferSize");
+const QString CapturePeriodSizeKey("capturePeriodSize");
+const QString PullModeEnabledKey("pullModeEnabled");
+const QString PowerSavingEnabledKey("powerSavingEnabled");
+const QString StrobeModeEnabledKey("strobeModeEnabled");
+const QString NoteKey("note");
+const QString FrequencyKey("frequency");
+const QString CentsKey("cents");
+const char *DefaultTuning("standard");
+const QString FramesAnalyzedKey("framesAnalyzed");
+const QString FramesGatedKey("framesGated");
+const QString SkipRatioKey("skipRatio");
+const QString NoiseFloorKey("noiseFloor");
+const QString OnsetsDetectedKey("onsetsDetected");
+const QString OnsetLatencyKey("onsetLatency");
+const QString FramesSkippedKey("framesSkipped");
+const QString SavedTimeKey("savedTimePerMinute");
+const QString BufferSizeKey("bufferSize");
+const QString PeriodSizeKey("periodSize");
+const QString NotifyIntervalKey("notifyInterval");
+const QString LatencyKey("latency");
+const QString HopKey("hop");
+const int DefaultTargetLatency(40); // In milliseconds
+const int PeriodsPerBuffer(4);
+const int MaximumChordNotes(32);
 
 
 /*!
@@ -39,24 +77,44 @@ GuitarTuner::GuitarTuner(QQuickItem *parent)
       m_voiceGenerator(0),
       m_audioInput(0),
       m_audioOutput(0),
+      m_audioInputDevice(0),
       m_isInput(true),
       m_isMuted(false),
       m_autoModeEnabled(false),
+      m_chromaticModeEnabled(false),
       m_sensitivity(0.5f),
       m_volume(0.5f),
+      m_tuning(Tuning::preset(DefaultTuning)),
       m_string(StringE),
-      m_autoDetectedString(StringE)
+      m_autoDetectedString(StringE),
+      m_voice(SineVoice),
+      m_harmonics(QVariantList() << 1.0),
+      m_targetLatency(DefaultTargetLatency),
+      m_captureBufferSize(0),
+      m_capturePeriodSize(0),
+      m_pullModeEnabled(false),
+      m_powerSavingEnabled(true),
+      m_meterValue(0),
+      m_meterActive(false),
+      m_pendingMeterValue(0),
+      m_pendingMeterActive(false),
+      m_isMeterPending(false),
+      m_strobeModeEnabled(false),
+      m_strobeCents(0),
+      m_strobeRotation(0),
+      m_strobeBeat(0),
+      m_pendingStrobeCents(0),
+      m_pendingStrobeBeat(0),
+      m_isAnalyzerTuningStale(false)
 {
-    // Initialize audio output and input.
-    initAudioOutput();
-    initAudioInput();
-
-    // Connect the signals of the voice analyzer.
-    connect(m_voiceAnalyzer, SIGNAL(lowVoice()), this, SIGNAL(lowVoice()));
-    connect(m_voiceAnalyzer, SIGNAL(correctFrequency()), this, SIGNAL(correctFrequency()));
-    connect(m_voiceAnalyzer, SIGNAL(voiceDifferenceChanged(qreal)),
-            this, SIGNAL(voiceDifferenceChanged(qreal)));
-    setIsInput(true);
+    // The audio devices and the DSP objects are created when their mode is
+    // first used. The analysis plans are built in the background, and the
+    // input is started once they are ready.
+    connect(this, SIGNAL(windowChanged(QQuickWindow*)),
+            this, SLOT(connectWindow(QQuickWindow*)));
+    connect(&m_analyzerWatcher, SIGNAL(finished()),
+            this, SLOT(adoptVoiceAnalyzer()));
+    initVoiceAnalyzer();
 }
 
 
@@ -65,7 +123,11 @@ GuitarTuner::GuitarTuner(QQuickItem *parent)
 */
 GuitarTuner::~GuitarTuner()
 {
-    // No implementation required.
+    if (!m_voiceAnalyzer && m_analyzerWatcher.future().isStarted()) {
+        // The analyzer being built is not owned yet.
+        m_analyzerWatcher.waitForFinished();
+        delete m_analyzerWatcher.result();
+    }
 }
 
 
@@ -79,14 +141,83 @@ QVariant GuitarTuner::settings() const
     retval.insert(IsInputKey, m_isInput);
     retval.insert(IsMutedKey, m_isMuted);
     retval.insert(AutoModeEnabledKey, m_autoModeEnabled);
+    retval.insert(ChromaticModeEnabledKey, m_chromaticModeEnabled);
     retval.insert(SensitivityKey, m_sensitivity);
     retval.insert(VolumeKey, m_volume);
-    retval.insert(StringKey, QVariant::fromValue((int)m_string));
+    retval.insert(StringKey, QVariant::fromValue(m_string));
+    retval.insert(TuningKey, tuning());
+    retval.insert(TuningStringsKey, strings());
+    retval.insert(VoiceKey, int(m_voice));
+    retval.insert(HarmonicsKey, m_harmonics);
+    retval.insert(ChordKey, m_chord);
+    retval.insert(TargetLatencyKey, m_targetLatency);
+    retval.insert(CaptureBufferSizeKey, m_captureBufferSize);
+    retval.insert(CapturePeriodSizeKey, m_capturePeriodSize);
+    retval.insert(PullModeEnabledKey, m_pullModeEnabled);
+    retval.insert(PowerSavingEnabledKey, m_powerSavingEnabled);
+    retval.insert(StrobeModeEnabledKey, m_strobeModeEnabled);
     qDebug() << "GuitarTuner::settings():" << retval;
     return QVariant::fromValue(retval);
 }
 
 
+/*!
+  Constructs and returns a variant map containing the work counters of the
+  voice analyzer, e.g. the share of the frames skipped by the energy gate,
+  the tracked noise floor in dBFS, the average time in seconds from a
+  pluck to the first reading, and the frames skipped by the power saving
+  with the estimated processing time in seconds it saves per minute.
+*/
+QVariant GuitarTuner::statistics() const
+{
+    QVariantMap retval;
+
+    if (!m_voiceAnalyzer) {
+        return QVariant::fromValue(retval);
+    }
+
+    const PitchAnalyzerStatistics &stats = m_voiceAnalyzer->statistics();
+    retval.insert(FramesAnalyzedKey, qlonglong(stats.framesAnalyzed));
+    retval.insert(FramesGatedKey, qlonglong(stats.framesGated));
+    retval.insert(SkipRatioKey, stats.skipRatio());
+    retval.insert(NoiseFloorKey, m_voiceAnalyzer->noiseFloorLevel());
+    retval.insert(OnsetsDetectedKey, qlonglong(stats.onsetsDetected));
+    retval.insert(OnsetLatencyKey, stats.averageOnsetLatency());
+    retval.insert(FramesSkippedKey, qlonglong(stats.framesSkipped));
+    retval.insert(SavedTimeKey, stats.savedTimePerMinute());
+    return QVariant::fromValue(retval);
+}
+
+
+/*!
+  Constructs and returns a variant map describing the capture buffer
+  granted by the audio input device: the buffer and period sizes in bytes,
+  the notify interval and the latency of a full buffer in milliseconds, and
+  the interval between two analyzed frames in milliseconds, or 0 if the
+  device did not report its period.
+*/
+QVariant GuitarTuner::captureConfiguration() const
+{
+    QVariantMap retval;
+
+    if (!m_audioInput) {
+        return QVariant::fromValue(retval);
+    }
+
+    const int bytesPerSecond = m_formatInput.frequency()
+            * m_formatInput.channels() * m_formatInput.sampleSize() / 8;
+    retval.insert(BufferSizeKey, m_audioInput->bufferSize());
+    retval.insert(PeriodSizeKey, m_audioInput->periodSize());
+    retval.insert(NotifyIntervalKey, m_audioInput->notifyInterval());
+    retval.insert(LatencyKey, bytesPerSecond > 0
+                  ? 1000.0 * m_audioInput->bufferSize() / bytesPerSecond : 0.0);
+    retval.insert(HopKey, m_formatInput.frequency() > 0
+                  ? 1000.0 * m_voiceAnalyzer->hopSize() / m_formatInput.frequency()
+                  : 0.0);
+    return QVariant::fromValue(retval);
+}
+
+
 /*!
   Suspends the audio output, if \a state is ActiveState and the voice is muted.
 */
@@ -121,12 +252,37 @@ void GuitarTuner::restoreSettings(QVariant settings)
     }
 
     qDebug() << "GuitarTuner::restoreSettings():" << map;
-    setString((String)map.value(StringKey).toInt()); // This needs to be set first!
+    // The tuning and the string need to be set first!
+    if (map.contains(TuningStringsKey)) {
+        setCustomTuning(map.value(TuningKey).toString(),
+                        map.value(TuningStringsKey).toList());
+    }
+
+    setString(map.value(StringKey).toInt());
     setIsInput(map.value(IsInputKey).toBool());
     setIsMuted(map.value(IsMutedKey).toBool());
     setAutoModeEnabled(map.value(AutoModeEnabledKey).toBool());
+    setChromaticModeEnabled(map.value(ChromaticModeEnabledKey).toBool());
     setSensitivity(map.value(SensitivityKey).toReal());
     setVolume(map.value(VolumeKey).toReal());
+    setVoice(Voice(map.value(VoiceKey, int(SineVoice)).toInt()));
+
+    if (map.contains(HarmonicsKey)) {
+        setHarmonics(map.value(HarmonicsKey).toList());
+    }
+
+    setChord(map.value(ChordKey).toList());
+
+    if (map.contains(TargetLatencyKey)) {
+        setTargetLatency(map.value(TargetLatencyKey).toInt());
+        setCaptureBufferSize(map.value(CaptureBufferSizeKey).toInt());
+        setCapturePeriodSize(map.value(CapturePeriodSizeKey).toInt());
+    }
+
+    setPullModeEnabled(map.value(PullModeEnabledKey).toBool());
+    setPowerSavingEnabled(map.value(PowerSavingEnabledKey, true).toBool());
+    setStrobeModeEnabled(map.value(StrobeModeEnabledKey).toBool());
+
     emit settingsRestored(true);
 }
 
@@ -140,11 +296,14 @@ void GuitarTuner::suspend()
     qDebug() << "GuitarTuner::suspend()";
 
     if (m_isInput) {
-        // Stop audio input and audio analyzer.
-        m_audioInput->stop();
-        m_voiceAnalyzer->stop();
+        // Stop audio input and audio analyzer, if created already.
+        if (m_voiceAnalyzer) {
+            m_audioInput->stop();
+            m_audioInputDevice = 0;
+            m_voiceAnalyzer->stop();
+        }
     }
-    else {
+    else if (m_voiceGenerator) {
         // Stop audio output and audio generator.
         m_audioOutput->stop();
         m_voiceGenerator->stop();
@@ -168,27 +327,33 @@ void GuitarTuner::setIsInput(bool isInput)
 {
     qDebug() << "GuitarTuner::setIsInput():" << isInput;
 
+    if (m_isInput == isInput
+            && (m_isInput ? m_voiceAnalyzer && m_voiceAnalyzer->isOpen()
+                          : m_voiceGenerator && m_voiceGenerator->isOpen())) {
+        // Already running in the mode, keep the audio device open.
+        return;
+    }
+
     // Stop audio input/output depending on the previous state.
     suspend();
 
     m_isInput = isInput;
 
     if (m_isInput) {
-        // Start the audio analyzer and then the audio input.
-        m_voiceAnalyzer->start(stringToFrequency(m_string));
-        m_audioInput->start(m_voiceAnalyzer);
+        // Start the audio analyzer and then the audio input. If the analyzer
+        // is still being built, the input is started once it is ready.
+        if (m_voiceAnalyzer) {
+            m_voiceAnalyzer->start();
+            startAudioInput();
+        }
     }
     else {
-        // Set up the audio output.
-
-        // If the current frequency of voice generator
-        // is not the same as the target frequency selected in the UI,
-        // update voice generator's frequency.
-        if (m_voiceGenerator->frequency() != stringToFrequency(m_string)) {
-            m_voiceGenerator->setFrequency(stringToFrequency(m_string));
+        if (!m_voiceGenerator) {
+            initAudioOutput();
         }
 
-        // Start the voice generator and then the audio output.
+        // Start the voice generator and then the audio output. The generator
+        // follows the selected string already.
         m_voiceGenerator->start();
 
         if (!m_isMuted) {
@@ -220,15 +385,18 @@ void GuitarTuner::setIsMuted(bool isMuted)
 
     m_isMuted = isMuted;
 
-    if (m_isMuted) {
-        m_audioOutput->suspend();
-    }
-    else {
-        if (m_audioOutput->state() == QAudio::SuspendedState) {
-            m_audioOutput->resume();
+    // Until the output is first used, the mute is only stored.
+    if (m_audioOutput) {
+        if (m_isMuted) {
+            m_audioOutput->suspend();
         }
         else {
-            m_audioOutput->start(m_voiceGenerator);
+            if (m_audioOutput->state() == QAudio::SuspendedState) {
+                m_audioOutput->resume();
+            }
+            else {
+                m_audioOutput->start(m_voiceGenerator);
+            }
         }
     }
 
@@ -256,19 +424,12 @@ void GuitarTuner::setAutoModeEnabled(bool autoModeEnabled)
 
         if (m_autoModeEnabled) {
             m_autoDetectedString = m_string;
-
-            // Start listening analyzer for automatic detection
-            connect(m_voiceAnalyzer, SIGNAL(voiceDifferenceChanged(qreal)),
-                    this, SLOT(autoDetectTargetFrequency(qreal)));
         }
-        else {
-            // Restore the original setting because that might have changed
-            // during the automatic detection
-            setString(m_string);
 
-            // Disconnect the signal-slot connection
-            disconnect(m_voiceAnalyzer, SIGNAL(voiceDifferenceChanged(qreal)),
-                       this, SLOT(autoDetectTargetFrequency(qreal)));
+        // In the auto mode the analyzer measures all the strings at once and
+        // reports the nearest one. Otherwise it measures the selected string.
+        if (m_voiceAnalyzer) {
+            m_voiceAnalyzer->setAutoModeEnabled(m_autoModeEnabled);
         }
 
         emit autoModeEnabledChanged(m_autoModeEnabled);
@@ -276,6 +437,35 @@ void GuitarTuner::setAutoModeEnabled(bool autoModeEnabled)
 }
 
 
+/*!
+  Returns true if the chromatic mode is enabled, false otherwise.
+*/
+bool GuitarTuner::chromaticModeEnabled() const
+{
+    return m_chromaticModeEnabled;
+}
+
+
+/*!
+  Enables the chromatic mode if \a chromaticModeEnabled is true. In the
+  chromatic mode the nearest note from A0 to C8 is reported with the
+  noteDetected() signal instead of measuring the strings. Note that the
+  chromatic mode only has effect if the input mode is on.
+*/
+void GuitarTuner::setChromaticModeEnabled(bool chromaticModeEnabled)
+{
+    if (m_chromaticModeEnabled != chromaticModeEnabled) {
+        m_chromaticModeEnabled = chromaticModeEnabled;
+
+        if (m_voiceAnalyzer) {
+            m_voiceAnalyzer->setChromaticModeEnabled(m_chromaticModeEnabled);
+        }
+
+        emit chromaticModeEnabledChanged(m_chromaticModeEnabled);
+    }
+}
+
+
 /*!
   Returns the set sensitivity level of the microphone.
 */
@@ -298,7 +488,11 @@ void GuitarTuner::setSensitivity(qreal sensitivity)
     qreal temp = m_sensitivity;
     temp = temp / 2 + 0.5; // No point of being below 0.5
     temp = 1 - temp;
-    m_voiceAnalyzer->setCutOffPercentage(temp);
+
+    if (m_voiceAnalyzer) {
+        m_voiceAnalyzer->setCutOffPercentage(temp);
+    }
+
     emit sensitivityChanged(m_sensitivity);
 }
 
@@ -324,7 +518,11 @@ void GuitarTuner::setVolume(qreal volume)
     }
 
     m_volume = volume;
-    m_voiceGenerator->setAmplitude(m_volume);
+
+    if (m_voiceGenerator) {
+        m_voiceGenerator->setAmplitude(m_volume);
+    }
+
     emit volumeChanged(m_volume);
 }
 
@@ -333,169 +531,1127 @@ void GuitarTuner::setVolume(qreal volume)
 */
 int GuitarTuner::string() const
 {
-    return (int)m_string;
+    return m_string;
 }
 
 
 /*!
   Sets the string, whose frequency is being analyzed or generated, to
-  \a string.
+  \a string, an index to the strings of the tuning.
 */
 void GuitarTuner::setString(int string)
 {
-    Q_ASSERT(string >= 0 && string < 6);
-    m_string = (String)string;
+    if (string < 0 || string >= m_tuning.stringCount()) {
+        qDebug() << "GuitarTuner::setString(): No string with index" << string;
+        return;
+    }
 
-    if (m_isInput) {
-        // Stop the audio input and voice analyzer.
-        m_audioInput->stop();
-        m_voiceAnalyzer->stop();
+    m_string = string;
 
-        // Start the voice analyzer with new frequency and audio input.
-        m_voiceAnalyzer->start(stringToFrequency(m_string));
-        m_audioInput->start(m_voiceAnalyzer);
+    // Retarget the voice analyzer and the voice generator in place. The audio
+    // devices keep running, and the analyzer keeps the samples it has
+    // collected for the current frame.
+    if (m_voiceAnalyzer) {
+        m_voiceAnalyzer->setString(m_string);
     }
-    else {
-        // Stop the audio output and voice generator.
-        m_audioOutput->stop();
-        m_voiceGenerator->stop();
 
-        // Set the voice generator's frequency to the target frequency.
-        m_voiceGenerator->setFrequency(stringToFrequency(m_string));
+    if (m_voiceGenerator) {
+        m_voiceGenerator->setString(m_string);
+    }
 
-        // Start the voice generator and audio output.
-        m_voiceGenerator->start();
+    emit stringChanged(m_string);
+}
 
-        if (!m_isMuted) {
-            m_audioOutput->start(m_voiceGenerator);
+
+/*!
+  Returns the name of the current tuning.
+*/
+QString GuitarTuner::tuning() const
+{
+    return QString::fromStdString(m_tuning.name());
+}
+
+
+/*!
+  Sets the tuning to the preset named \a tuning, see tuningNames().
+*/
+void GuitarTuner::setTuning(const QString &tuning)
+{
+    if (tuning == this->tuning()) {
+        return;
+    }
+
+    Tuning preset = Tuning::preset(tuning.toStdString());
+
+    if (!preset.isValid()) {
+        qDebug() << "GuitarTuner::setTuning(): No preset named" << tuning;
+        return;
+    }
+
+    applyTuning(preset);
+}
+
+
+/*!
+  Returns the names of the preset tunings.
+*/
+QStringList GuitarTuner::tuningNames() const
+{
+    QStringList retval;
+    std::vector<std::string> names = Tuning::presetNames();
+
+    for (size_t i = 0; i < names.size(); ++i) {
+        retval.append(QString::fromStdString(names[i]));
+    }
+
+    return retval;
+}
+
+
+/*!
+  Returns the strings of the current tuning, in the order of the strings
+  on the instrument, i.e. from the lowest except for re-entrant tunings like
+  the ukulele, as a list of variant maps with the note name, the nominal
+  frequency and the offset in cents.
+*/
+QVariantList GuitarTuner::strings() const
+{
+    QVariantList retval;
+
+    for (int i = 0; i < m_tuning.stringCount(); ++i) {
+        const TuningString &string = m_tuning.string(i);
+        QVariantMap map;
+        map.insert(NoteKey, QString::fromStdString(string.name));
+        map.insert(FrequencyKey, string.frequency);
+        map.insert(CentsKey, string.centOffset);
+        retval.append(map);
+    }
+
+    return retval;
+}
+
+
+/*!
+  Sets the tuning to a tuning named \a name, consisting of \a strings. Each
+  string is either a note name, e.g. "F#1" or "Bb3", a frequency in Hz, or a
+  variant map with a note or a frequency and an optional offset in cents,
+  like the maps returned by strings(). Returns false if a string can not be
+  interpreted, in which case the tuning is not changed.
+*/
+bool GuitarTuner::setCustomTuning(const QString &name,
+                                  const QVariantList &strings)
+{
+    std::vector<TuningString> tuningStrings;
+
+    foreach (const QVariant &value, strings) {
+        QVariantMap map;
+
+        if (value.type() == QVariant::String) {
+            map.insert(NoteKey, value);
         }
+        else if (value.type() == QVariant::Map) {
+            map = value.toMap();
+        }
+        else {
+            map.insert(FrequencyKey, value);
+        }
+
+        TuningString string;
+        string.name = map.value(NoteKey).toString().toStdString();
+        string.centOffset = map.value(CentsKey).toReal();
+
+        if (map.contains(FrequencyKey)) {
+            string.frequency = map.value(FrequencyKey).toReal();
+        }
+        else if (!Tuning::noteToFrequency(string.name, &string.frequency)) {
+            qDebug() << "GuitarTuner::setCustomTuning(): Invalid note" << value;
+            return false;
+        }
+
+        tuningStrings.push_back(string);
     }
 
-    emit stringChanged((int)m_string);
+    Tuning tuning(name.toStdString(), tuningStrings);
+
+    if (!tuning.isValid()) {
+        qDebug() << "GuitarTuner::setCustomTuning(): Invalid tuning" << strings;
+        return false;
+    }
+
+    applyTuning(tuning);
+    return true;
 }
 
 
 /*!
-  Initializes the audio input.
+  Plucks the reference tone again, if the voice is PluckedVoice. Note that
+  the voice is only heard in the output mode.
 */
-void GuitarTuner::initAudioInput()
+void GuitarTuner::pluck()
 {
-    // Set up the input format.
-    m_formatInput.setFrequency(DataFrequencyHzInput);
-    m_formatInput.setCodec("audio/pcm");
-    m_formatInput.setSampleSize(16);
-    m_formatInput.setChannels(1);
-    m_formatInput.setByteOrder(QAudioFormat::LittleEndian);
-    m_formatInput.setSampleType(QAudioFormat::SignedInt);
+    if (m_voiceGenerator) {
+        m_voiceGenerator->pluck();
+    }
+}
+
+
+/*!
+  Returns the buffer, to which the spectrum of each analyzed frame is
+  published for SpectrumView. The spectrumUpdated() signal is emitted
+  after each one.
+*/
+SpectrumBuffer *GuitarTuner::spectrumBuffer() const
+{
+    return m_voiceAnalyzer ? m_voiceAnalyzer->spectrumBuffer() : 0;
+}
+
+
+/*!
+  Returns the voice of the reference tone.
+*/
+GuitarTuner::Voice GuitarTuner::voice() const
+{
+    return m_voice;
+}
 
-    // Obtain a default input device, and if the format is not
-    // supported, find the nearest format available.
-    QAudioDeviceInfo inputDeviceInfo(QAudioDeviceInfo::defaultInputDevice());
 
-    if (!inputDeviceInfo.isFormatSupported(m_formatInput)) {
-        m_formatInput = inputDeviceInfo.nearestFormat(m_formatInput);
+/*!
+  Sets the voice of the reference tone to \a voice, a sine or a plucked
+  string tuned to the selected string.
+*/
+void GuitarTuner::setVoice(Voice voice)
+{
+    if (m_voice == voice) {
+        return;
     }
 
-    // Create new QAudioInput and VoiceAnalyzer instances, and store them in
-    // m_audioInput and m_voiceAnalyzer, respectively. Remember to set the cut-off
-    // percentage for voice analyzer.
-    m_audioInput = new QAudioInput(inputDeviceInfo, m_formatInput, this);
-    m_voiceAnalyzer = new VoiceAnalyzer(m_formatInput, this);
-    setSensitivity(m_sensitivity);
+    m_voice = voice;
+
+    if (m_voiceGenerator) {
+        m_voiceGenerator->setVoice(m_voice == PluckedVoice
+                                   ? ToneGenerator::PluckedVoice
+                                   : ToneGenerator::SineVoice);
+    }
+
+    emit voiceChanged(m_voice);
 }
 
 
 /*!
-  Initializes the audio output.
+  Returns the amplitudes of the harmonics of the reference tone, from the
+  fundamental.
 */
-void GuitarTuner::initAudioOutput()
+QVariantList GuitarTuner::harmonics() const
 {
-    // Set up the output format.
-    m_formatOutput.setFrequency(DataFrequencyHzOutput);
-    m_formatOutput.setCodec("audio/pcm");
-    m_formatOutput.setSampleSize(16);
-    m_formatOutput.setChannels(1);
-    m_formatOutput.setByteOrder(QAudioFormat::LittleEndian);
-    m_formatOutput.setSampleType(QAudioFormat::SignedInt);
+    return m_harmonics;
+}
 
-    // Obtain a default output device, and if the format is not supported,
-    // find the nearest format available.
-    QAudioDeviceInfo outputDeviceInfo(QAudioDeviceInfo::defaultOutputDevice());
 
-    if (!outputDeviceInfo.isFormatSupported(m_formatOutput)) {
-        m_formatOutput = outputDeviceInfo.nearestFormat(m_formatOutput);
+/*!
+  Sets the amplitudes of the harmonics of the reference tone to
+  \a harmonics, from the fundamental, e.g. [1, 0.5, 0.33, 0.25] for a
+  string-like tone or [1, 0, 0.3, 0, 0.1] for a hollow, organ-like one. The
+  tone is scaled to the same peak level whatever the harmonics are, and the
+  harmonics above the Nyquist frequency are left out. Ignored unless at
+  least one amplitude is non-zero.
+*/
+void GuitarTuner::setHarmonics(const QVariantList &harmonics)
+{
+    if (harmonics == m_harmonics) {
+        return;
     }
 
-    // Create new QAudioOutput and VoiceGenerator instances, and store
-    // them in m_audioOutput and m_voiceGenerator, respectively.
-    m_audioOutput = new QAudioOutput(outputDeviceInfo,
-                                     m_formatOutput, this);
-    m_voiceGenerator = new VoiceGenerator(m_formatOutput,
-                                          stringToFrequency(m_string),
-                                          m_volume,
-                                          this);
+    std::vector<double> amplitudes;
+    bool isAudible(false);
 
-    // Connect m_audioOutput stateChanged signal to outputStateChanged.
-    connect(m_audioOutput, SIGNAL(stateChanged(QAudio::State)),
-            SIGNAL(outputStateChanged(QAudio::State)));
+    foreach (const QVariant &value, harmonics) {
+        bool ok(false);
+        const double amplitude = value.toDouble(&ok);
+
+        if (!ok || !qIsFinite(amplitude)) {
+            qDebug() << "GuitarTuner::setHarmonics(): Invalid amplitude" << value;
+            return;
+        }
+
+        isAudible = isAudible || amplitude != 0;
+        amplitudes.push_back(amplitude);
+    }
+
+    if (!isAudible) {
+        qDebug() << "GuitarTuner::setHarmonics(): No audible harmonics" << harmonics;
+        return;
+    }
+
+    m_harmonics = harmonics;
+
+    if (m_voiceGenerator) {
+        m_voiceGenerator->setHarmonics(amplitudes);
+    }
+
+    emit harmonicsChanged(m_harmonics);
+}
+
+
+/*!
+  Returns true if \a chord is a list of notes, rather than of the gains of
+  the strings, see GuitarTuner::setChord().
+*/
+static bool isNoteList(const QVariantList &chord)
+{
+    return !chord.isEmpty() && chord.first().type() == QVariant::Map;
 }
 
 
 /*!
-  Maps \a string to correct frequency and returns the frequency value.
+  Returns \a chord, validated by setChord(), as the notes of the chord.
 */
-qreal GuitarTuner::stringToFrequency(String string) const
+static std::vector<ToneGenerator::ChordNote> toChordNotes(
+        const QVariantList &chord)
 {
-    switch (string) {
-    case StringE: return FrequencyE;
-    case StringA: return FrequencyA;
-    case StringD: return FrequencyD;
-    case StringG: return FrequencyG;
-    case StringB: return FrequencyB;
-    case Stringe: return Frequencye;
+    std::vector<ToneGenerator::ChordNote> retval;
+
+    for (int i = 0; i < chord.count(); ++i) {
+        const QVariant &value = chord.at(i);
+
+        if (value.type() == QVariant::Map) {
+            const QVariantMap note = value.toMap();
+            retval.push_back(ToneGenerator::ChordNote(
+                                 note.value(StringKey).toInt(),
+                                 note.value(GainKey, 1.0).toDouble(),
+                                 note.value(OctaveKey, 0).toInt()));
+        }
+        else {
+            retval.push_back(ToneGenerator::ChordNote(i, value.toDouble()));
+        }
     }
 
-    return 1;
+    return retval;
+}
+
+
+/*!
+  Returns the notes of the chord played in the output mode, or an empty
+  list if the selected string is played.
+*/
+QVariantList GuitarTuner::chord() const
+{
+    return m_chord;
 }
 
 
 /*!
-  Detects the nearest target frequency (string) based on \a voiceDifference and
-  emits GuitarTuner::autoDetectedStringChanged() signal.
+  Plays the strings of the tuning at once in the output mode. \a chord is
+  either a list of gains or a list of notes. A gain is the gain of the
+  string at its index, in the order of the tuning. E.g. [1, 1, 1, 1, 1, 1]
+  plays all the strings of a guitar, [0, 0, 0, 1, 1] the G and B strings,
+  and [1, 0, 0, 0, 0, 1] the E strings as a drone. A note is a map,
+  { "string": 0, "gain": 0.5, "octave": -1 }, so that the strings can also
+  be repeated and doubled up to three octaves above or below, up to 32
+  notes in all. The gain defaults to 1 and the octave to 0. The strings
+  without a gain are silent, and the mix is scaled so that it does not
+  clip. An empty \a chord plays the selected string again.
 */
-void GuitarTuner::autoDetectTargetFrequency(qreal voiceDifference)
+void GuitarTuner::setChord(const QVariantList &chord)
 {
-    qreal tempDifference = abs(voiceDifference);
-    qreal tempIndex = (qreal)m_autoDetectedString;
-    qreal tempInterval(StringInterval);
+    if (chord == m_chord) {
+        return;
+    }
 
-    if ((qRound(tempIndex) - (voiceDifference < 0)) == (int)Stringe) {
-        tempInterval = 5000;
+    if (chord.count() > MaximumChordNotes) {
+        qDebug() << "GuitarTuner::setChord(): Too many notes" << chord;
+        return;
     }
 
-    while (!(voiceDifference < 0 && tempIndex == 0)
-           && tempDifference >= tempInterval)
-    {
-        tempDifference -= tempInterval;
-        tempIndex += voiceDifference / abs(voiceDifference);
+    const bool isNotes = isNoteList(chord);
 
-        if ((qRound(tempIndex) - (voiceDifference < 0)) == (int)Stringe) {
-            tempInterval = 5000;
+    for (int i = 0; i < chord.count(); ++i) {
+        const QVariant &value = chord.at(i);
+        bool ok(false);
+        double gain(0);
+
+        if (isNotes != (value.type() == QVariant::Map)) {
+            qDebug() << "GuitarTuner::setChord(): Gains mixed with notes"
+                     << chord;
+            return;
+        }
+
+        if (isNotes) {
+            const QVariantMap note = value.toMap();
+            bool isStringValid(false);
+            bool isOctaveValid(false);
+            const int string = note.value(StringKey).toInt(&isStringValid);
+            note.value(OctaveKey, 0).toInt(&isOctaveValid);
+            gain = note.value(GainKey, 1.0).toDouble(&ok);
+            ok = ok && isStringValid && isOctaveValid
+                    && string >= 0 && string < m_tuning.stringCount();
         }
         else {
-            tempInterval = StringInterval;
+            gain = value.toDouble(&ok);
+            ok = ok && i < m_tuning.stringCount();
+        }
+
+        if (!ok || !qIsFinite(gain) || gain < 0) {
+            qDebug() << "GuitarTuner::setChord(): Invalid note" << value;
+            return;
         }
     }
 
-    int tempString = qRound(tempIndex);
+    m_chord = chord;
 
-    if (tempString != (int)m_autoDetectedString
-            && tempString >= (int)StringE && tempString <= (int)Stringe)
-    {
-        m_autoDetectedString = (String)tempString;
-        qDebug() << "GuitarTuner::autoDetectTargetFrequency(): Detected string with index" << m_autoDetectedString;
-        m_voiceAnalyzer->setFrequency(stringToFrequency(m_autoDetectedString));
-        emit autoDetectedStringChanged(m_autoDetectedString);
+    if (m_voiceGenerator) {
+        m_voiceGenerator->setChord(toChordNotes(m_chord));
+    }
+
+    emit chordChanged(m_chord);
+}
+
+
+/*!
+  Returns the target latency of the capture buffer in milliseconds, or 0 if
+  the buffer size of the audio input device is used.
+*/
+int GuitarTuner::targetLatency() const
+{
+    return m_targetLatency;
+}
+
+
+/*!
+  Sets the target latency of the capture buffer to \a targetLatency
+  milliseconds, or to the default of the audio input device if 0. The
+  buffer is sized to hold \a targetLatency of audio unless
+  captureBufferSize is set. A running audio input is restarted.
+*/
+void GuitarTuner::setTargetLatency(int targetLatency)
+{
+    if (m_targetLatency == targetLatency || targetLatency < 0) {
+        return;
+    }
+
+    m_targetLatency = targetLatency;
+    restartAudioInput();
+    emit captureSettingsChanged();
+}
+
+
+/*!
+  Returns the requested size of the capture buffer in bytes, or 0 if it
+  follows the target latency.
+*/
+int GuitarTuner::captureBufferSize() const
+{
+    return m_captureBufferSize;
+}
+
+
+/*!
+  Sets the requested size of the capture buffer to \a captureBufferSize
+  bytes, or to follow the target latency if 0. The device may grant another
+  size, see captureConfiguration(). A running audio input is restarted.
+*/
+void GuitarTuner::setCaptureBufferSize(int captureBufferSize)
+{
+    if (m_captureBufferSize == captureBufferSize || captureBufferSize < 0) {
+        return;
+    }
+
+    m_captureBufferSize = captureBufferSize;
+    restartAudioInput();
+    emit captureSettingsChanged();
+}
+
+
+/*!
+  Returns the requested amount of data delivered by the audio input device
+  at a time in bytes, or 0 if it is a quarter of the buffer.
+*/
+int GuitarTuner::capturePeriodSize() const
+{
+    return m_capturePeriodSize;
+}
+
+
+/*!
+  Sets the requested amount of data delivered by the audio input device at
+  a time to \a capturePeriodSize bytes, or to a quarter of the buffer if 0.
+  The period is requested with the notify interval of the device, which may
+  grant another period, see captureConfiguration(). A running audio input
+  is restarted.
+*/
+void GuitarTuner::setCapturePeriodSize(int capturePeriodSize)
+{
+    if (m_capturePeriodSize == capturePeriodSize || capturePeriodSize < 0) {
+        return;
+    }
+
+    m_capturePeriodSize = capturePeriodSize;
+    restartAudioInput();
+    emit captureSettingsChanged();
+}
+
+
+/*!
+  Returns true if the data is pulled from the audio input device, false if
+  the device pushes it to the analyzer.
+*/
+bool GuitarTuner::pullModeEnabled() const
+{
+    return m_pullModeEnabled;
+}
+
+
+/*!
+  Pulls the data from the audio input device if \a pullModeEnabled is true,
+  otherwise lets the device push it. In the pull mode the data is read in
+  blocks of a capture period on each notify of the device. A running audio
+  input is restarted.
+*/
+void GuitarTuner::setPullModeEnabled(bool pullModeEnabled)
+{
+    if (m_pullModeEnabled == pullModeEnabled) {
+        return;
+    }
+
+    m_pullModeEnabled = pullModeEnabled;
+    restartAudioInput();
+    emit pullModeEnabledChanged(m_pullModeEnabled);
+}
+
+
+/*!
+  Returns true if the analysis is slowed down while the reading is stable or
+  nothing is played.
+*/
+bool GuitarTuner::powerSavingEnabled() const
+{
+    return m_powerSavingEnabled;
+}
+
+
+/*!
+  Slows the analysis down, to up to every eighth frame, while the reading is
+  stable or nothing is played if \a powerSavingEnabled is true. A pluck or a
+  changing reading restores the full rate. The saved processing time is
+  reported by statistics().
+*/
+void GuitarTuner::setPowerSavingEnabled(bool powerSavingEnabled)
+{
+    if (m_powerSavingEnabled == powerSavingEnabled) {
+        return;
+    }
+
+    m_powerSavingEnabled = powerSavingEnabled;
+
+    if (m_voiceAnalyzer) {
+        m_voiceAnalyzer->setPowerSavingEnabled(m_powerSavingEnabled);
+    }
+
+    emit powerSavingEnabledChanged(m_powerSavingEnabled);
+}
+
+
+/*!
+  Returns the voice difference shown by the meter, in semitones. Follows
+  the smoothed voice difference, but changes at most once per rendered
+  frame.
+*/
+qreal GuitarTuner::meterValue() const
+{
+    return m_meterValue;
+}
+
+
+/*!
+  Returns true if the meter shows a reading, false if the voice is too low.
+  Changes at most once per rendered frame.
+*/
+bool GuitarTuner::meterActive() const
+{
+    return m_meterActive;
+}
+
+
+/*!
+  Returns true if the strobe mode is enabled.
+*/
+bool GuitarTuner::strobeModeEnabled() const
+{
+    return m_strobeModeEnabled;
+}
+
+
+/*!
+  Enables the strobe mode if \a strobeModeEnabled is true. In the strobe
+  mode the difference from the target is also measured from the phase of
+  the voice, to a fraction of a cent, see strobeCents() and
+  strobeRotation(). The analysis runs at twice the rate and the power
+  saving is suspended. Does not apply to the chromatic mode.
+*/
+void GuitarTuner::setStrobeModeEnabled(bool strobeModeEnabled)
+{
+    if (m_strobeModeEnabled == strobeModeEnabled) {
+        return;
+    }
+
+    m_strobeModeEnabled = strobeModeEnabled;
+
+    if (m_voiceAnalyzer) {
+        m_voiceAnalyzer->setStrobeModeEnabled(m_strobeModeEnabled);
+    }
+
+    if (!m_strobeModeEnabled) {
+        setPendingStrobeLost();
+    }
+
+    emit strobeModeEnabledChanged(m_strobeModeEnabled);
+}
+
+
+/*!
+  Returns the difference from the target in cents measured by the strobe.
+  Keeps the last measured value while there is none, and changes at most
+  once per rendered frame.
+*/
+qreal GuitarTuner::strobeCents() const
+{
+    return m_strobeCents;
+}
+
+
+/*!
+  Returns the angle of the strobe in degrees, from 0 to 360. The strobe
+  turns once per period of the difference between the voice and the target
+  frequency, clockwise when sharp, and stands still when in tune or when
+  nothing is measured. Advanced on every rendered frame while it turns.
+*/
+qreal GuitarTuner::strobeRotation() const
+{
+    return m_strobeRotation;
+}
+
+
+/*!
+  Returns \a values, validated by the property setters, as amplitudes.
+*/
+static std::vector<double> toAmplitudes(const QVariantList &values)
+{
+    std::vector<double> retval;
+
+    foreach (const QVariant &value, values) {
+        retval.push_back(value.toDouble());
+    }
+
+    return retval;
+}
+
+
+/*!
+  Builds the voice analyzer for \a format with the analysis plans of
+  \a tuning, targeted at \a string. Run in the background, so the analyzer
+  is moved to \a thread before it is returned.
+*/
+static VoiceAnalyzer *createVoiceAnalyzer(const QAudioFormat &format,
+                                          const Tuning &tuning, int string,
+                                          QThread *thread)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    VoiceAnalyzer *analyzer = new VoiceAnalyzer(format);
+    analyzer->setTuning(tuning);
+    analyzer->setString(string);
+    analyzer->moveToThread(thread);
+
+    qDebug() << "createVoiceAnalyzer(): Analysis plans built in"
+             << timer.elapsed() << "ms";
+    return analyzer;
+}
+
+
+/*!
+  Chooses the input format and starts building the voice analyzer in the
+  background. The audio input is created once the analyzer is ready, see
+  adoptVoiceAnalyzer().
+*/
+void GuitarTuner::initVoiceAnalyzer()
+{
+    // Set up the input format.
+    m_formatInput.setFrequency(DataFrequencyHzInput);
+    m_formatInput.setCodec("audio/pcm");
+    m_formatInput.setSampleSize(16);
+    m_formatInput.setChannels(1);
+    m_formatInput.setByteOrder(QAudioFormat::LittleEndian);
+    m_formatInput.setSampleType(QAudioFormat::SignedInt);
+
+    // Obtain a default input device, and if the format is not
+    // supported, find the nearest format available.
+    m_inputDeviceInfo = QAudioDeviceInfo::defaultInputDevice();
+
+    if (!m_inputDeviceInfo.isFormatSupported(m_formatInput)) {
+        m_formatInput = m_inputDeviceInfo.nearestFormat(m_formatInput);
+    }
+
+    m_isAnalyzerTuningStale = false;
+    m_analyzerWatcher.setFuture(QtConcurrent::run(createVoiceAnalyzer,
+                                                  m_formatInput, m_tuning,
+                                                  m_string, thread()));
+}
+
+
+/*!
+  Takes the voice analyzer built in the background into use, applies the
+  current settings to it, and creates the audio input. Starts the input, if
+  the tuner is in the input mode.
+*/
+void GuitarTuner::adoptVoiceAnalyzer()
+{
+    m_voiceAnalyzer = m_analyzerWatcher.result();
+    m_voiceAnalyzer->setParent(this);
+
+    if (m_isAnalyzerTuningStale) {
+        // The tuning was changed while the analyzer was being built.
+        m_voiceAnalyzer->setTuning(m_tuning);
+    }
+
+    m_voiceAnalyzer->setString(m_string);
+
+    m_voiceAnalyzer->setAutoModeEnabled(m_autoModeEnabled);
+    m_voiceAnalyzer->setChromaticModeEnabled(m_chromaticModeEnabled);
+    m_voiceAnalyzer->setPowerSavingEnabled(m_powerSavingEnabled);
+    m_voiceAnalyzer->setStrobeModeEnabled(m_strobeModeEnabled);
+
+    // Create the QAudioInput instance, and store it in m_audioInput.
+    // Remember to set the cut-off percentage for voice analyzer.
+    m_audioInput = new QAudioInput(m_inputDeviceInfo, m_formatInput, this);
+    setSensitivity(m_sensitivity);
+
+    // In the pull mode the data is read on each notify.
+    connect(m_audioInput, SIGNAL(notify()), this, SLOT(readAudioInput()));
+
+    // Connect the signals of the voice analyzer.
+    connect(m_voiceAnalyzer, SIGNAL(lowVoice()), this, SIGNAL(lowVoice()));
+    connect(m_voiceAnalyzer, SIGNAL(correctFrequency()), this, SIGNAL(correctFrequency()));
+    connect(m_voiceAnalyzer, SIGNAL(voiceDifferenceChanged(qreal)),
+            this, SIGNAL(voiceDifferenceChanged(qreal)));
+    connect(m_voiceAnalyzer, SIGNAL(smoothedVoiceDifferenceChanged(qreal, qreal)),
+            this, SIGNAL(smoothedVoiceDifferenceChanged(qreal, qreal)));
+    connect(m_voiceAnalyzer, SIGNAL(detectedStringChanged(int)),
+            this, SLOT(setAutoDetectedString(int)));
+    connect(m_voiceAnalyzer, SIGNAL(noteDetected(int, qreal)),
+            this, SLOT(setDetectedNote(int, qreal)));
+
+    // The meter is updated at most once per rendered frame.
+    connect(m_voiceAnalyzer, SIGNAL(smoothedVoiceDifferenceChanged(qreal, qreal)),
+            this, SLOT(setPendingMeterValue(qreal, qreal)));
+    connect(m_voiceAnalyzer, SIGNAL(lowVoice()), this, SLOT(setPendingLowVoice()));
+    connect(m_voiceAnalyzer, SIGNAL(strobeMeasured(qreal, qreal)),
+            this, SLOT(setPendingStrobe(qreal, qreal)));
+    connect(m_voiceAnalyzer, SIGNAL(strobeLost()), this, SLOT(setPendingStrobeLost()));
+
+    // Let the spectrum views know of a new frame.
+    connect(m_voiceAnalyzer, SIGNAL(spectrumUpdated()), this, SIGNAL(spectrumUpdated()));
+
+    if (m_isInput) {
+        m_voiceAnalyzer->start();
+        startAudioInput();
+    }
+}
+
+
+/*!
+  Initializes the audio output.
+*/
+void GuitarTuner::initAudioOutput()
+{
+    // Set up the output format.
+    m_formatOutput.setFrequency(DataFrequencyHzOutput);
+    m_formatOutput.setCodec("audio/pcm");
+    m_formatOutput.setSampleSize(16);
+    m_formatOutput.setChannels(1);
+    m_formatOutput.setByteOrder(QAudioFormat::LittleEndian);
+    m_formatOutput.setSampleType(QAudioFormat::SignedInt);
+
+    // Obtain a default output device, and if the format is not supported,
+    // find the nearest format available.
+    QAudioDeviceInfo outputDeviceInfo(QAudioDeviceInfo::defaultOutputDevice());
+
+    if (!outputDeviceInfo.isFormatSupported(m_formatOutput)) {
+        m_formatOutput = outputDeviceInfo.nearestFormat(m_formatOutput);
+    }
+
+    // Create new QAudioOutput and VoiceGenerator instances, and store
+    // them in m_audioOutput and m_voiceGenerator, respectively.
+    m_audioOutput = new QAudioOutput(outputDeviceInfo,
+                                     m_formatOutput, this);
+    m_voiceGenerator = new VoiceGenerator(m_formatOutput,
+                                          stringToFrequency(m_string),
+                                          m_volume,
+                                          this);
+    m_voiceGenerator->setTuning(m_tuning);
+    m_voiceGenerator->setString(m_string);
+
+    // Apply the settings changed before the output was first used.
+    if (m_voice != SineVoice) {
+        m_voiceGenerator->setVoice(ToneGenerator::PluckedVoice);
+    }
+
+    if (m_harmonics != (QVariantList() << 1.0)) {
+        m_voiceGenerator->setHarmonics(toAmplitudes(m_harmonics));
+    }
+
+    if (!m_chord.isEmpty()) {
+        m_voiceGenerator->setChord(toChordNotes(m_chord));
+    }
+
+    // Connect m_audioOutput stateChanged signal to outputStateChanged.
+    connect(m_audioOutput, SIGNAL(stateChanged(QAudio::State)),
+            SIGNAL(outputStateChanged(QAudio::State)));
+}
+
+
+/*!
+  Requests the capture buffer and period from the audio input device and
+  starts it, pushing the data to the voice analyzer or, in the pull mode,
+  letting the analyzer read it. The frames of the analyzer are scheduled to
+  end at the end of the granted period, so that each frame is analyzed as
+  soon as the device delivers its last sample. In the pull mode the period
+  is the notify interval if the device does not report one.
+*/
+void GuitarTuner::startAudioInput()
+{
+    const int bytesPerFrame = m_formatInput.channels()
+            * m_formatInput.sampleSize() / 8;
+    const int bytesPerSecond = m_formatInput.frequency() * bytesPerFrame;
+    int bufferSize = m_captureBufferSize;
+
+    if (bufferSize == 0 && bytesPerFrame > 0) {
+        bufferSize = qint64(m_targetLatency) * bytesPerSecond / 1000
+                / bytesPerFrame * bytesPerFrame;
+    }
+
+    if (bufferSize > 0 && bytesPerSecond > 0) {
+        m_audioInput->setBufferSize(bufferSize);
+        const int requestedPeriodSize = (m_capturePeriodSize > 0)
+                ? m_capturePeriodSize : bufferSize / PeriodsPerBuffer;
+        m_audioInput->setNotifyInterval(
+                    qMax(1, int(qint64(requestedPeriodSize) * 1000
+                                / bytesPerSecond)));
+    }
+
+    int periodSize(0);
+
+    if (m_pullModeEnabled) {
+        m_audioInputDevice = m_audioInput->start();
+        periodSize = m_audioInput->periodSize();
+
+        if (periodSize <= 0) {
+            periodSize = qint64(m_audioInput->notifyInterval()) * bytesPerSecond
+                    / 1000 / qMax(1, bytesPerFrame) * bytesPerFrame;
+        }
+    }
+    else {
+        m_audioInput->start(m_voiceAnalyzer);
+        periodSize = m_audioInput->periodSize();
+    }
+
+    m_voiceAnalyzer->setCapturePeriod((periodSize > 0 && bytesPerFrame > 0)
+                                      ? periodSize / bytesPerFrame : 0);
+
+    qDebug() << "GuitarTuner::startAudioInput(): Requested" << bufferSize
+             << "bytes, granted" << m_audioInput->bufferSize()
+             << "bytes in periods of" << periodSize << "bytes";
+}
+
+
+/*!
+  Restarts the audio input with the current capture settings, if it is
+  running.
+*/
+void GuitarTuner::restartAudioInput()
+{
+    if (!m_isInput || !m_voiceAnalyzer || !m_voiceAnalyzer->isOpen()) {
+        return;
+    }
+
+    m_audioInput->stop();
+    m_audioInputDevice = 0;
+    startAudioInput();
+}
+
+
+/*!
+  Schedules the pending meter state to be published before the next frame
+  is rendered. Without a window it is published at once.
+*/
+void GuitarTuner::scheduleMeterUpdate()
+{
+    if (m_isMeterPending) {
+        // Coalesced with the update already scheduled.
+        return;
+    }
+
+    m_isMeterPending = true;
+
+    if (window()) {
+        window()->update();
+    }
+    else {
+        updateMeter();
+    }
+}
+
+
+/*!
+  Turns the strobe by the time elapsed since it was last advanced, and asks
+  for the next frame while it turns.
+*/
+void GuitarTuner::advanceStrobe()
+{
+    if (m_strobeBeat == 0) {
+        m_strobeTimer.invalidate();
+        return;
+    }
+
+    if (m_strobeTimer.isValid()) {
+        const qreal elapsed = m_strobeTimer.nsecsElapsed() / 1e9;
+        m_strobeRotation = fmod(m_strobeRotation + 360 * m_strobeBeat * elapsed,
+                                360);
+
+        if (m_strobeRotation < 0) {
+            m_strobeRotation += 360;
+        }
+
+        emit strobeRotationChanged(m_strobeRotation);
+    }
+
+    m_strobeTimer.start();
+
+    if (window()) {
+        window()->update();
+    }
+}
+
+
+/*!
+  Reads the whole capture periods ready in the audio input device to the
+  voice analyzer, in the pull mode.
+*/
+void GuitarTuner::readAudioInput()
+{
+    if (!m_audioInputDevice) {
+        return;
+    }
+
+    m_voiceAnalyzer->readBlocks(m_audioInputDevice, m_audioInput->bytesReady());
+}
+
+
+/*!
+  Takes \a tuning into use. The analysis plans and the reference tones of
+  the strings are computed here, so that switching the strings later is
+  cheap. Selects the first
+  string if the current string is not in the tuning.
+*/
+void GuitarTuner::applyTuning(const Tuning &tuning)
+{
+    const int previousString = m_string;
+    m_tuning = tuning;
+
+    if (m_string >= m_tuning.stringCount()) {
+        m_string = 0;
+    }
+
+    if (m_autoDetectedString >= m_tuning.stringCount()) {
+        m_autoDetectedString = m_string;
+    }
+
+    if (m_voiceAnalyzer) {
+        m_voiceAnalyzer->setTuning(m_tuning);
+        m_voiceAnalyzer->setString(m_string);
+    }
+    else {
+        // The analyzer being built gets the tuning once it is ready.
+        m_isAnalyzerTuningStale = true;
+    }
+
+    if (m_voiceGenerator) {
+        m_voiceGenerator->setTuning(m_tuning);
+        m_voiceGenerator->setString(m_string);
+    }
+
+    // The generator leaves the strings missing from the tuning out of the
+    // chord. A list of gains has a gain per string, but a list of notes may
+    // have more notes than strings, so only the notes of the missing strings
+    // are dropped from it.
+    QVariantList chord;
+
+    if (isNoteList(m_chord)) {
+        foreach (const QVariant &value, m_chord) {
+            if (value.toMap().value(StringKey).toInt()
+                    < m_tuning.stringCount()) {
+                chord.append(value);
+            }
+        }
+    }
+    else {
+        chord = m_chord.mid(0, m_tuning.stringCount());
+    }
+
+    const bool isChordTrimmed = chord.count() != m_chord.count();
+
+    if (isChordTrimmed) {
+        m_chord = chord;
+    }
+
+    qDebug() << "GuitarTuner::applyTuning():" << this->tuning() << strings();
+    emit tuningChanged(this->tuning());
+
+    if (m_string != previousString) {
+        emit stringChanged(m_string);
+    }
+
+    if (isChordTrimmed) {
+        emit chordChanged(m_chord);
+    }
+}
+
+
+/*!
+  Returns the target frequency of \a string in the current tuning.
+*/
+qreal GuitarTuner::stringToFrequency(int string) const
+{
+    return m_tuning.string(string).targetFrequency();
+}
+
+
+/*!
+  Stores \a string, detected by the analyzer in the auto mode, and emits
+  GuitarTuner::autoDetectedStringChanged() signal if the string changed.
+*/
+void GuitarTuner::setAutoDetectedString(int string)
+{
+    if (!m_autoModeEnabled || string == m_autoDetectedString) {
+        return;
+    }
+
+    m_autoDetectedString = string;
+    qDebug() << "GuitarTuner::setAutoDetectedString(): Detected string with index" << m_autoDetectedString;
+    emit autoDetectedStringChanged(m_autoDetectedString);
+}
+
+
+
+/*!
+  Emits GuitarTuner::noteDetected() signal with the name and the octave of
+  \a note, detected by the analyzer in the chromatic mode, and
+  \a voiceDifference in cents.
+*/
+void GuitarTuner::setDetectedNote(int note, qreal voiceDifference)
+{
+    if (!m_chromaticModeEnabled) {
+        return;
+    }
+
+    emit noteDetected(QString::fromStdString(Tuning::noteName(note)),
+                      note / 12, voiceDifference * 100);
+}
+
+
+/*!
+  Keeps \a voiceDifference, tracked over frames, to be shown by the meter on
+  the next frame. Only the latest value is shown if the analyzer produces
+  several in one frame.
+*/
+void GuitarTuner::setPendingMeterValue(qreal voiceDifference, qreal confidence)
+{
+    Q_UNUSED(confidence);
+
+    m_pendingMeterValue = voiceDifference;
+    m_pendingMeterActive = true;
+    scheduleMeterUpdate();
+}
+
+
+/*!
+  Turns the meter inactive on the next frame.
+*/
+void GuitarTuner::setPendingLowVoice()
+{
+    m_pendingMeterActive = false;
+    scheduleMeterUpdate();
+}
+
+
+/*!
+  Keeps \a cents and \a beat, the difference from the target in cents and
+  in Hz measured by the strobe, to be shown on the next frame.
+*/
+void GuitarTuner::setPendingStrobe(qreal cents, qreal beat)
+{
+    m_pendingStrobeCents = cents;
+    m_pendingStrobeBeat = beat;
+    scheduleMeterUpdate();
+}
+
+
+/*!
+  Stops the strobe on the next frame.
+*/
+void GuitarTuner::setPendingStrobeLost()
+{
+    m_pendingStrobeBeat = 0;
+    scheduleMeterUpdate();
+}
+
+
+/*!
+  Publishes the meter state once per frame of \a window, the window the
+  item is shown in.
+*/
+void GuitarTuner::connectWindow(QQuickWindow *window)
+{
+    if (window) {
+        connect(window, SIGNAL(afterAnimating()), this, SLOT(updateMeter()),
+                Qt::UniqueConnection);
+    }
+}
+
+
+/*!
+  Advances the strobe, and publishes the pending meter state, if any. Called
+  when the animations of a frame have been advanced, before the frame is
+  synchronized for rendering.
+*/
+void GuitarTuner::updateMeter()
+{
+    advanceStrobe();
+
+    if (!m_isMeterPending) {
+        return;
+    }
+
+    m_isMeterPending = false;
+
+    if (m_pendingStrobeBeat != 0 && m_strobeCents != m_pendingStrobeCents) {
+        m_strobeCents = m_pendingStrobeCents;
+        emit strobeCentsChanged(m_strobeCents);
+    }
+
+    if (m_strobeBeat != m_pendingStrobeBeat) {
+        // Turn at the new rate from this frame on.
+        m_strobeBeat = m_pendingStrobeBeat;
+        advanceStrobe();
+    }
+
+    if (m_pendingMeterActive && m_meterValue != m_pendingMeterValue) {
+        m_meterValue = m_pendingMeterValue;
+        emit meterValueChanged(m_meterValue);
+    }
+
+    if (m_meterActive != m_pendingMeterActive) {
+        m_meterActive = m_pendingMeterActive;
+        emit meterActiveChanged(m_meterActive);
     }
 }
 
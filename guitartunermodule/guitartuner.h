@@ -5,14 +5,23 @@
 #ifndef GUITARTUNER_H
 #define GUITARTUNER_H
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QStringList>
 #include <QtCore/QVariant>
 #include <QtMultimediaKit/qaudio.h>
+#include <QtMultimediaKit/QAudioDeviceInfo>
 #include <QtMultimediaKit/QAudioFormat>
 #include <QtQuick/QQuickItem>
 
+#include "tuning.h"
+
 // Forward declarations
 class QAudioInput;
 class QAudioOutput;
+class QIODevice;
+class QQuickWindow;
+class SpectrumBuffer;
 class VoiceAnalyzer;
 class VoiceGenerator;
 
@@ -24,13 +33,31 @@ class GuitarTuner : public QQuickItem
     Q_PROPERTY(bool isInput READ isInput WRITE setIsInput NOTIFY isInputChanged)
     Q_PROPERTY(bool isMuted READ isMuted WRITE setIsMuted NOTIFY isMutedChanged)
     Q_PROPERTY(bool autoModeEnabled READ autoModeEnabled WRITE setAutoModeEnabled NOTIFY autoModeEnabledChanged)
+    Q_PROPERTY(bool chromaticModeEnabled READ chromaticModeEnabled WRITE setChromaticModeEnabled NOTIFY chromaticModeEnabledChanged)
     Q_PROPERTY(qreal sensitivity READ sensitivity WRITE setSensitivity NOTIFY sensitivityChanged)
     Q_PROPERTY(qreal volume READ volume WRITE setVolume NOTIFY volumeChanged)
     Q_PROPERTY(int string READ string WRITE setString NOTIFY stringChanged)
-    Q_ENUMS(String)
+    Q_PROPERTY(QString tuning READ tuning WRITE setTuning NOTIFY tuningChanged)
+    Q_PROPERTY(QStringList tuningNames READ tuningNames CONSTANT)
+    Q_PROPERTY(QVariantList strings READ strings NOTIFY tuningChanged)
+    Q_PROPERTY(Voice voice READ voice WRITE setVoice NOTIFY voiceChanged)
+    Q_PROPERTY(QVariantList harmonics READ harmonics WRITE setHarmonics NOTIFY harmonicsChanged)
+    Q_PROPERTY(QVariantList chord READ chord WRITE setChord NOTIFY chordChanged)
+    Q_PROPERTY(int targetLatency READ targetLatency WRITE setTargetLatency NOTIFY captureSettingsChanged)
+    Q_PROPERTY(int captureBufferSize READ captureBufferSize WRITE setCaptureBufferSize NOTIFY captureSettingsChanged)
+    Q_PROPERTY(int capturePeriodSize READ capturePeriodSize WRITE setCapturePeriodSize NOTIFY captureSettingsChanged)
+    Q_PROPERTY(bool pullModeEnabled READ pullModeEnabled WRITE setPullModeEnabled NOTIFY pullModeEnabledChanged)
+    Q_PROPERTY(bool powerSavingEnabled READ powerSavingEnabled WRITE setPowerSavingEnabled NOTIFY powerSavingEnabledChanged)
+    Q_PROPERTY(qreal meterValue READ meterValue NOTIFY meterValueChanged)
+    Q_PROPERTY(bool meterActive READ meterActive NOTIFY meterActiveChanged)
+    Q_PROPERTY(bool strobeModeEnabled READ strobeModeEnabled WRITE setStrobeModeEnabled NOTIFY strobeModeEnabledChanged)
+    Q_PROPERTY(qreal strobeCents READ strobeCents NOTIFY strobeCentsChanged)
+    Q_PROPERTY(qreal strobeRotation READ strobeRotation NOTIFY strobeRotationChanged)
+    Q_ENUMS(String Voice)
 
 public: // Data types
 
+    // The strings of the standard tuning
     enum String {
         StringE = 0,
         StringA,
@@ -40,12 +67,24 @@ public: // Data types
         Stringe
     };
 
+    // The reference tones of the output mode
+    enum Voice {
+        SineVoice = 0,
+        PluckedVoice
+    };
+
 public:
     explicit GuitarTuner(QQuickItem *parent = 0);
     ~GuitarTuner();
 
 public:
     Q_INVOKABLE QVariant settings() const;
+    Q_INVOKABLE QVariant statistics() const;
+    Q_INVOKABLE QVariant captureConfiguration() const;
+    Q_INVOKABLE bool setCustomTuning(const QString &name,
+                                     const QVariantList &strings);
+    Q_INVOKABLE void pluck();
+    SpectrumBuffer *spectrumBuffer() const;
 
 public slots:
     void setOutputState(QAudio::State state);
@@ -59,51 +98,135 @@ private: // Property setters and getters
     void setIsMuted(bool isMuted);
     bool autoModeEnabled() const;
     void setAutoModeEnabled(bool autoModeEnabled);
+    bool chromaticModeEnabled() const;
+    void setChromaticModeEnabled(bool chromaticModeEnabled);
     qreal sensitivity() const;
     void setSensitivity(qreal sensitivity);
     qreal volume() const;
     void setVolume(qreal volume);
     int string() const;
     void setString(int string);
+    QString tuning() const;
+    void setTuning(const QString &tuning);
+    QStringList tuningNames() const;
+    QVariantList strings() const;
+    Voice voice() const;
+    void setVoice(Voice voice);
+    QVariantList harmonics() const;
+    void setHarmonics(const QVariantList &harmonics);
+    QVariantList chord() const;
+    void setChord(const QVariantList &chord);
+    int targetLatency() const;
+    void setTargetLatency(int targetLatency);
+    int captureBufferSize() const;
+    void setCaptureBufferSize(int captureBufferSize);
+    int capturePeriodSize() const;
+    void setCapturePeriodSize(int capturePeriodSize);
+    bool pullModeEnabled() const;
+    void setPullModeEnabled(bool pullModeEnabled);
+    bool powerSavingEnabled() const;
+    void setPowerSavingEnabled(bool powerSavingEnabled);
+    qreal meterValue() const;
+    bool meterActive() const;
+    bool strobeModeEnabled() const;
+    void setStrobeModeEnabled(bool strobeModeEnabled);
+    qreal strobeCents() const;
+    qreal strobeRotation() const;
 
 private:
-    void initAudioInput();
+    void initVoiceAnalyzer();
     void initAudioOutput();
-    qreal stringToFrequency(String string) const;
+    void startAudioInput();
+    void restartAudioInput();
+    void scheduleMeterUpdate();
+    void advanceStrobe();
+    void applyTuning(const Tuning &tuning);
+    qreal stringToFrequency(int string) const;
 
 private slots:
-    void autoDetectTargetFrequency(qreal voiceDifference);
+    void setAutoDetectedString(int string);
+    void setDetectedNote(int note, qreal voiceDifference);
+    void readAudioInput();
+    void adoptVoiceAnalyzer();
+    void setPendingMeterValue(qreal voiceDifference, qreal confidence);
+    void setPendingLowVoice();
+    void setPendingStrobe(qreal cents, qreal beat);
+    void setPendingStrobeLost();
+    void connectWindow(QQuickWindow *window);
+    void updateMeter();
 
 signals: // Property signals
     void isInputChanged(bool isInput);
     void isMutedChanged(bool isMuted);
     void autoModeEnabledChanged(bool autoModeEnabled);
+    void chromaticModeEnabledChanged(bool chromaticModeEnabled);
     void sensitivityChanged(qreal sensitivity);
     void volumeChanged(qreal volume);
     void stringChanged(int string);
+    void tuningChanged(const QString &tuning);
+    void voiceChanged(Voice voice);
+    void harmonicsChanged(const QVariantList &harmonics);
+    void chordChanged(const QVariantList &chord);
+    void captureSettingsChanged();
+    void pullModeEnabledChanged(bool pullModeEnabled);
+    void powerSavingEnabledChanged(bool powerSavingEnabled);
+    void meterValueChanged(qreal meterValue);
+    void meterActiveChanged(bool meterActive);
+    void strobeModeEnabledChanged(bool strobeModeEnabled);
+    void strobeCentsChanged(qreal strobeCents);
+    void strobeRotationChanged(qreal strobeRotation);
 
 signals:
     void outputStateChanged(QAudio::State state);
     void lowVoice();
     void correctFrequency();
     void voiceDifferenceChanged(qreal voiceDifference);
+    void smoothedVoiceDifferenceChanged(qreal voiceDifference, qreal confidence);
     void autoDetectedStringChanged(int string);
+    void noteDetected(const QString &note, int octave, qreal cents);
     void settingsRestored(bool wasSuccessful);
+    void spectrumUpdated();
 
 private: // Data
     VoiceAnalyzer *m_voiceAnalyzer; // Owned
     VoiceGenerator *m_voiceGenerator; // Owned
     QAudioInput *m_audioInput; // Owned
     QAudioOutput *m_audioOutput; // Owned
+    QIODevice *m_audioInputDevice; // Not owned, set in the pull mode
+    QAudioDeviceInfo m_inputDeviceInfo;
     QAudioFormat m_formatInput;
     QAudioFormat m_formatOutput;
     bool m_isInput;
     bool m_isMuted;
     bool m_autoModeEnabled;
+    bool m_chromaticModeEnabled;
     qreal m_sensitivity;
     qreal m_volume;
-    String m_string;
-    String m_autoDetectedString;
+    Tuning m_tuning;
+    int m_string;
+    int m_autoDetectedString;
+    Voice m_voice;
+    QVariantList m_harmonics;
+    QVariantList m_chord;
+    int m_targetLatency; // In milliseconds, or 0 for the device default
+    int m_captureBufferSize; // In bytes, or 0 to follow the target latency
+    int m_capturePeriodSize; // In bytes, or 0 for a quarter of the buffer
+    bool m_pullModeEnabled;
+    bool m_powerSavingEnabled;
+    qreal m_meterValue;
+    bool m_meterActive;
+    qreal m_pendingMeterValue; // Published on the next frame
+    bool m_pendingMeterActive;
+    bool m_isMeterPending;
+    bool m_strobeModeEnabled;
+    qreal m_strobeCents;
+    qreal m_strobeRotation; // In degrees, from 0 to 360
+    qreal m_strobeBeat; // Turns per second of the strobe
+    qreal m_pendingStrobeCents; // Published on the next frame
+    qreal m_pendingStrobeBeat;
+    QElapsedTimer m_strobeTimer; // Since the strobe was last advanced
+    QFutureWatcher<VoiceAnalyzer *> m_analyzerWatcher; // Builds m_voiceAnalyzer
+    bool m_isAnalyzerTuningStale; // The tuning changed while it was built
 
     Q_DISABLE_COPY(GuitarTuner)
 };
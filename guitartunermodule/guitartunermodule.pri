@@ -1,22 +1,24 @@
 # Copyright (c) 2012 Nokia Corporation.
 
 CONFIG += qt plugin
+QT += concurrent
+
+include(../dspcore/dspcore.pri)
 
 INCLUDEPATH += $$PWD
 
 HEADERS += \
-    $$PWD/constants.h \
-    $$PWD/fastfouriertransformer.h \
+    $$PWD/audioformatconverter.h \
     $$PWD/guitartuner.h \
     $$PWD/guitartunerplugin.h \
+    $$PWD/spectrumview.h \
     $$PWD/voiceanalyzer.h \
     $$PWD/voicegenerator.h
 
 SOURCES += \
-    $$PWD/fastfouriertransformer.cpp \
-    $$PWD/fftpack.c \
     $$PWD/guitartuner.cpp \
     $$PWD/guitartunerplugin.cpp \
+    $$PWD/spectrumview.cpp \
     $$PWD/voiceanalyzer.cpp \
     $$PWD/voicegenerator.cpp
 
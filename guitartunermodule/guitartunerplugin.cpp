@@ -4,10 +4,12 @@
 
 #include "guitartunerplugin.h"
 #include "guitartuner.h"
+#include "spectrumview.h"
 
 void GuitarTunerPlugin::registerTypes(const char *uri)
 {
     // @uri mymodule
     qmlRegisterType<GuitarTuner>(uri, 1, 0, "GuitarTuner");
+    qmlRegisterType<SpectrumView>(uri, 1, 0, "SpectrumView");
     qRegisterMetaType<GuitarTuner::String>("String");
 }
@@ -0,0 +1,486 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#include "spectrumview.h"
+
+#include <math.h>
+#include <algorithm>
+#include <QtCore/qmath.h>
+#include <QtQuick/QQuickWindow>
+#include <QtQuick/QSGFlatColorMaterial>
+#include <QtQuick/QSGGeometryNode>
+#include <QtQuick/QSGRectangleNode>
+#include <QtQuick/QSGRendererInterface>
+
+#include "spectrumbuffer.h"
+
+// The children of the root node with the line geometry.
+enum LineNode {
+    SpectrumLine = 0,
+    WaveformLine,
+    PeakLine,
+    LineNodeCount
+};
+
+// The number of the bars drawn for the spectrum and the waveform with the
+// software backend, which does not draw custom geometry.
+const int BarCount(96);
+
+// The densities are shown in decibels relative to the strongest one.
+const qreal DefaultRange(60.0);
+
+
+/*!
+  \class SpectrumView
+  \brief Draws the spectrum, the waveform and the detected peak of the
+         frames analyzed by GuitarTuner.
+
+  The view takes the latest spectrum published by the analyzer in the
+  scene graph's updatePaintNode(), from a lock-free SpectrumBuffer, so the
+  analysis is never blocked by the rendering. A frame is drawn once per
+  rendered frame at most, however fast the analyzer is.
+
+  The spectrum is drawn over a logarithmic frequency axis, the strongest
+  density at the top and \a range decibels below it at the bottom. The
+  waveform is drawn across the view, centered vertically. With an OpenGL
+  backend they are line strips of QSGGeometry. The software backend does
+  not draw custom geometry, so they are drawn as bars of rectangle nodes
+  instead.
+
+  \code
+  SpectrumView {
+      anchors.fill: parent
+      tuner: guitarTuner
+  }
+  \endcode
+*/
+
+
+/*!
+  Constructor.
+*/
+SpectrumView::SpectrumView(QQuickItem *parent)
+    : QQuickItem(parent),
+      m_spectrumColor(Qt::green),
+      m_waveformColor(Qt::gray),
+      m_peakColor(Qt::white),
+      m_range(DefaultRange),
+      m_isDirty(true)
+{
+    setFlag(ItemHasContents, true);
+}
+
+
+/*!
+  Returns the tuner whose analysis is shown.
+*/
+GuitarTuner *SpectrumView::tuner() const
+{
+    return m_tuner;
+}
+
+
+/*!
+  Shows the analysis of \a tuner.
+*/
+void SpectrumView::setTuner(GuitarTuner *tuner)
+{
+    if (m_tuner == tuner) {
+        return;
+    }
+
+    if (m_tuner) {
+        disconnect(m_tuner, SIGNAL(spectrumUpdated()), this, SLOT(update()));
+    }
+
+    m_tuner = tuner;
+
+    if (m_tuner) {
+        connect(m_tuner, SIGNAL(spectrumUpdated()), this, SLOT(update()));
+    }
+
+    m_isDirty = true;
+    update();
+    emit tunerChanged(tuner);
+}
+
+
+/*!
+  Returns the color of the spectrum.
+*/
+QColor SpectrumView::spectrumColor() const
+{
+    return m_spectrumColor;
+}
+
+
+/*!
+  Sets the color of the spectrum to \a color.
+*/
+void SpectrumView::setSpectrumColor(const QColor &color)
+{
+    if (m_spectrumColor == color) {
+        return;
+    }
+
+    m_spectrumColor = color;
+    m_isDirty = true;
+    update();
+    emit colorsChanged();
+}
+
+
+/*!
+  Returns the color of the waveform.
+*/
+QColor SpectrumView::waveformColor() const
+{
+    return m_waveformColor;
+}
+
+
+/*!
+  Sets the color of the waveform to \a color.
+*/
+void SpectrumView::setWaveformColor(const QColor &color)
+{
+    if (m_waveformColor == color) {
+        return;
+    }
+
+    m_waveformColor = color;
+    m_isDirty = true;
+    update();
+    emit colorsChanged();
+}
+
+
+/*!
+  Returns the color of the line marking the detected peak.
+*/
+QColor SpectrumView::peakColor() const
+{
+    return m_peakColor;
+}
+
+
+/*!
+  Sets the color of the line marking the detected peak to \a color.
+*/
+void SpectrumView::setPeakColor(const QColor &color)
+{
+    if (m_peakColor == color) {
+        return;
+    }
+
+    m_peakColor = color;
+    m_isDirty = true;
+    update();
+    emit colorsChanged();
+}
+
+
+/*!
+  Returns the range of the densities shown, in decibels below the
+  strongest one.
+*/
+qreal SpectrumView::range() const
+{
+    return m_range;
+}
+
+
+/*!
+  Shows the densities down to \a range decibels below the strongest one.
+*/
+void SpectrumView::setRange(qreal range)
+{
+    if (m_range == range || range <= 0) {
+        return;
+    }
+
+    m_range = range;
+    m_isDirty = true;
+    update();
+    emit rangeChanged(m_range);
+}
+
+
+/*!
+  From QQuickItem. Called on the rendering thread while the GUI thread is
+  blocked. Takes the latest spectrum and updates the nodes, \a oldNode, if
+  there is a new one or the view has changed.
+*/
+QSGNode *SpectrumView::updatePaintNode(QSGNode *oldNode,
+                                       UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data);
+
+    // The buffer is created with the voice analyzer.
+    SpectrumBuffer *buffer = m_tuner ? m_tuner->spectrumBuffer() : 0;
+
+    if (!buffer) {
+        delete oldNode;
+        return 0;
+    }
+
+    const Spectrum *spectrum = buffer->takeLatest();
+
+    if (!spectrum) {
+        if (oldNode && !m_isDirty) {
+            return oldNode;
+        }
+
+        spectrum = &buffer->front();
+    }
+
+    m_isDirty = false;
+
+    if (window()->rendererInterface()->graphicsApi()
+            == QSGRendererInterface::Software) {
+        return updateBars(oldNode, *spectrum);
+    }
+
+    return updateLines(oldNode, *spectrum);
+}
+
+
+/*!
+  From QQuickItem. Redraws the view in its new size.
+*/
+void SpectrumView::geometryChanged(const QRectF &newGeometry,
+                                   const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+
+    if (newGeometry.size() != oldGeometry.size()) {
+        m_isDirty = true;
+        update();
+    }
+}
+
+
+/*!
+  Creates a node drawing its vertices in \a drawingMode with a flat color.
+*/
+static QSGGeometryNode *createLineNode(unsigned int drawingMode)
+{
+    QSGGeometry *geometry =
+            new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+    geometry->setDrawingMode(drawingMode);
+    geometry->setLineWidth(1);
+
+    QSGGeometryNode *node = new QSGGeometryNode;
+    node->setGeometry(geometry);
+    node->setFlag(QSGNode::OwnsGeometry);
+    node->setMaterial(new QSGFlatColorMaterial);
+    node->setFlag(QSGNode::OwnsMaterial);
+    return node;
+}
+
+
+/*!
+  Sets the color of the line \a node to \a color.
+*/
+static void setLineColor(QSGGeometryNode *node, const QColor &color)
+{
+    QSGFlatColorMaterial *material =
+            static_cast<QSGFlatColorMaterial *>(node->material());
+
+    if (material->color() != color) {
+        material->setColor(color);
+        node->markDirty(QSGNode::DirtyMaterial);
+    }
+}
+
+
+/*!
+  Draws \a spectrum with line geometry to the children of \a node, created
+  if 0. Returns the node.
+*/
+QSGNode *SpectrumView::updateLines(QSGNode *node, const Spectrum &spectrum)
+{
+    if (!node) {
+        node = new QSGNode;
+        node->appendChildNode(createLineNode(QSGGeometry::DrawLineStrip));
+        node->appendChildNode(createLineNode(QSGGeometry::DrawLineStrip));
+        node->appendChildNode(createLineNode(QSGGeometry::DrawLines));
+    }
+
+    QSGGeometryNode *lines[LineNodeCount];
+
+    for (int i = 0; i < LineNodeCount; ++i) {
+        lines[i] = static_cast<QSGGeometryNode *>(node->childAtIndex(i));
+    }
+
+    setLineColor(lines[SpectrumLine], m_spectrumColor);
+    setLineColor(lines[WaveformLine], m_waveformColor);
+    setLineColor(lines[PeakLine], m_peakColor);
+
+    // The spectrum, one vertex per density.
+    const int densityCount = int(spectrum.densities.size());
+    const float maximum = densityCount > 0
+            ? *std::max_element(spectrum.densities.begin(),
+                                spectrum.densities.end())
+            : 0;
+    QSGGeometry *geometry = lines[SpectrumLine]->geometry();
+    geometry->allocate(densityCount);
+    QSGGeometry::Point2D *vertices = geometry->vertexDataAsPoint2D();
+
+    for (int i = 0; i < densityCount; ++i) {
+        vertices[i].set(frequencyToX(spectrum, spectrum.firstFrequency
+                                     + i * spectrum.binWidth),
+                        densityToY(spectrum.densities[i], maximum));
+    }
+
+    lines[SpectrumLine]->markDirty(QSGNode::DirtyGeometry);
+
+    // The waveform, one vertex per sample.
+    const int sampleCount = int(spectrum.waveform.size());
+    geometry = lines[WaveformLine]->geometry();
+    geometry->allocate(sampleCount);
+    vertices = geometry->vertexDataAsPoint2D();
+    const qreal center = height() / 2;
+
+    for (int i = 0; i < sampleCount; ++i) {
+        vertices[i].set(sampleCount > 1 ? width() * i / (sampleCount - 1) : 0,
+                        center * (1 - spectrum.waveform[i]));
+    }
+
+    lines[WaveformLine]->markDirty(QSGNode::DirtyGeometry);
+
+    // The peak, a vertical line.
+    geometry = lines[PeakLine]->geometry();
+
+    if (spectrum.peakFrequency > 0 && densityCount > 0) {
+        const qreal x = frequencyToX(spectrum, spectrum.peakFrequency);
+        geometry->allocate(2);
+        vertices = geometry->vertexDataAsPoint2D();
+        vertices[0].set(x, 0);
+        vertices[1].set(x, height());
+    }
+    else {
+        geometry->allocate(0);
+    }
+
+    lines[PeakLine]->markDirty(QSGNode::DirtyGeometry);
+    return node;
+}
+
+
+/*!
+  Draws \a spectrum with rectangle nodes to the children of \a node,
+  created if 0: BarCount bars of the spectrum, BarCount bars of the
+  waveform envelope and the peak. Returns the node.
+*/
+QSGNode *SpectrumView::updateBars(QSGNode *node, const Spectrum &spectrum)
+{
+    if (!node) {
+        node = new QSGNode;
+
+        for (int i = 0; i < 2 * BarCount + 1; ++i) {
+            node->appendChildNode(window()->createRectangleNode());
+        }
+    }
+
+    const qreal barWidth = width() / BarCount;
+
+    // The spectrum, the strongest density in the range of each bar.
+    float bars[BarCount];
+    std::fill(bars, bars + BarCount, 0.0f);
+    const int densityCount = int(spectrum.densities.size());
+    float maximum = 0;
+
+    for (int i = 0; i < densityCount; ++i) {
+        const qreal x = frequencyToX(spectrum, spectrum.firstFrequency
+                                     + i * spectrum.binWidth);
+        const int bar = qBound(0, int(x / barWidth), BarCount - 1);
+        bars[bar] = qMax(bars[bar], spectrum.densities[i]);
+        maximum = qMax(maximum, spectrum.densities[i]);
+    }
+
+    for (int i = 0; i < BarCount; ++i) {
+        QSGRectangleNode *rectangle =
+                static_cast<QSGRectangleNode *>(node->childAtIndex(i));
+        const qreal y = densityCount > 0 ? densityToY(bars[i], maximum)
+                                         : height();
+        rectangle->setRect(QRectF(i * barWidth, y, barWidth, height() - y));
+        rectangle->setColor(m_spectrumColor);
+    }
+
+    // The waveform, the span of the samples under each bar.
+    const int sampleCount = int(spectrum.waveform.size());
+    const qreal center = height() / 2;
+
+    for (int i = 0; i < BarCount; ++i) {
+        const int first = sampleCount * i / BarCount;
+        const int last = qMax(first + 1, sampleCount * (i + 1) / BarCount);
+        float low = 0;
+        float high = 0;
+
+        for (int j = first; j < last && j < sampleCount; ++j) {
+            low = qMin(low, spectrum.waveform[j]);
+            high = qMax(high, spectrum.waveform[j]);
+        }
+
+        QSGRectangleNode *rectangle = static_cast<QSGRectangleNode *>(
+                    node->childAtIndex(BarCount + i));
+        rectangle->setRect(QRectF(i * barWidth, center * (1 - high),
+                                  barWidth, qMax(qreal(1), center * (high - low))));
+        rectangle->setColor(m_waveformColor);
+    }
+
+    // The peak.
+    QSGRectangleNode *peak = static_cast<QSGRectangleNode *>(
+                node->childAtIndex(2 * BarCount));
+
+    if (spectrum.peakFrequency > 0 && densityCount > 0) {
+        peak->setRect(QRectF(frequencyToX(spectrum, spectrum.peakFrequency) - 1,
+                             0, 2, height()));
+    }
+    else {
+        peak->setRect(QRectF());
+    }
+
+    peak->setColor(m_peakColor);
+    return node;
+}
+
+
+/*!
+  Returns the x coordinate of \a frequency on the logarithmic frequency axis
+  spanning the densities of \a spectrum.
+*/
+qreal SpectrumView::frequencyToX(const Spectrum &spectrum,
+                                 double frequency) const
+{
+    const double first = spectrum.firstFrequency;
+    const double last = first + (int(spectrum.densities.size()) - 1)
+            * spectrum.binWidth;
+
+    if (first <= 0 || last <= first) {
+        return 0;
+    }
+
+    return width() * qLn(frequency / first) / qLn(last / first);
+}
+
+
+/*!
+  Returns the y coordinate of \a density, \a maximum being at the top and
+  range() decibels below it at the bottom.
+*/
+qreal SpectrumView::densityToY(float density, float maximum) const
+{
+    if (density <= 0 || maximum <= 0) {
+        return height();
+    }
+
+    // The densities are squared, hence 10 * log10().
+    const qreal decibels = 10 * log10(density / maximum);
+    return height() * qBound(qreal(0), -decibels / m_range, qreal(1));
+}
+
+
+QML_DECLARE_TYPE(SpectrumView)
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2012 Nokia Corporation.
+ */
+
+#ifndef SPECTRUMVIEW_H
+#define SPECTRUMVIEW_H
+
+#include <QtCore/QPointer>
+#include <QtGui/QColor>
+#include <QtQuick/QQuickItem>
+
+#include "guitartuner.h"
+
+// Forward declarations
+class QSGGeometryNode;
+struct Spectrum;
+
+
+class SpectrumView : public QQuickItem
+{
+    Q_OBJECT
+
+    Q_PROPERTY(GuitarTuner *tuner READ tuner WRITE setTuner NOTIFY tunerChanged)
+    Q_PROPERTY(QColor spectrumColor READ spectrumColor WRITE setSpectrumColor NOTIFY colorsChanged)
+    Q_PROPERTY(QColor waveformColor READ waveformColor WRITE setWaveformColor NOTIFY colorsChanged)
+    Q_PROPERTY(QColor peakColor READ peakColor WRITE setPeakColor NOTIFY colorsChanged)
+    Q_PROPERTY(qreal range READ range WRITE setRange NOTIFY rangeChanged)
+
+public:
+    explicit SpectrumView(QQuickItem *parent = 0);
+
+public:
+    GuitarTuner *tuner() const;
+    void setTuner(GuitarTuner *tuner);
+    QColor spectrumColor() const;
+    void setSpectrumColor(const QColor &color);
+    QColor waveformColor() const;
+    void setWaveformColor(const QColor &color);
+    QColor peakColor() const;
+    void setPeakColor(const QColor &color);
+    qreal range() const;
+    void setRange(qreal range);
+
+protected: // From QQuickItem
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data);
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry);
+
+private:
+    QSGNode *updateLines(QSGNode *node, const Spectrum &spectrum);
+    QSGNode *updateBars(QSGNode *node, const Spectrum &spectrum);
+    qreal frequencyToX(const Spectrum &spectrum, double frequency) const;
+    qreal densityToY(float density, float maximum) const;
+
+signals:
+    void tunerChanged(GuitarTuner *tuner);
+    void colorsChanged();
+    void rangeChanged(qreal range);
+
+private:
+    QPointer<GuitarTuner> m_tuner;
+    QColor m_spectrumColor;
+    QColor m_waveformColor;
+    QColor m_peakColor;
+    qreal m_range; // Decibels from the top of the view to the bottom
+    bool m_isDirty; // Redraw even if there is no new spectrum
+};
+
+#endif // SPECTRUMVIEW_H
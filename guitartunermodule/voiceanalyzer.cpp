@@ -5,30 +5,18 @@
 #include "voiceanalyzer.h"
 
 #include <QtCore/QDebug>
-#include <QtCore/qmath.h>
-#include <QtCore/qendian.h>
 
-#include "constants.h"
-#include "fastfouriertransformer.h"
-
-// Constant used to scale the cut-off density for the fft helper.
-const static float CutOffScaler(0.05);
-
-// Force the precision to be "1/PrecisionPerNote" notes near the target
-// frequency.
-const static int PrecisionPerNote(4);
-
-// TargetFrequencyParameter is a constant which implies the index at which
-// corresponds to the target frequency. 0.5 * N * 1 / TargetFrequencyParameter
-// is (about) the index which corresponds to the given target frequency.
-// Effectively TargetFrequencyParameter = 2^z, and the z * TargetFrequency
-// is the maximum frequency that can be noticed.
-const static int TargetFrequencyParameter(4);
+#include "audioformatconverter.h"
 
 
 /*!
   \class VoiceAnalyzer
-  \brief Analyzes the data received from the audio input device.
+  \brief Adapts PitchAnalyzer to a QIODevice receiving the data from the
+         audio input device.
+
+  In the push mode the audio input device writes the data to the analyzer
+  in chunks of any size. In the pull mode the data is read from the device
+  with readBlocks() in blocks of a capture period.
 */
 
 
@@ -37,53 +25,30 @@ const static int TargetFrequencyParameter(4);
 */
 VoiceAnalyzer::VoiceAnalyzer(const QAudioFormat &format, QObject *parent)
     : QIODevice(parent),
-      m_fftHelper(0),
-      m_format(format),
-      m_totalSampleCount(0),
-      m_maximumVoiceDifference(0),
-      m_stepSize(0),
-      m_frequency(0),
-      m_position(0)
+      m_analyzer(toPcmFormat(format)),
+      m_detectedString(-1)
 {
-    Q_ASSERT(qFuzzyCompare(M_SAMPLE_COUNT_MULTIPLIER,
-                           float(2) / (M_TWELTH_ROOT_OF_2 - 1.0)));
-
-    m_fftHelper = new FastFourierTransformer(this);
-    m_totalSampleCount = qRound(qreal(PrecisionPerNote)
-                                * TargetFrequencyParameter
-                                * M_SAMPLE_COUNT_MULTIPLIER);
-    m_samples.reserve(m_totalSampleCount);
-
-    int i(2);
-    int j(1);
-
-    for (; i < TargetFrequencyParameter; i *= 2) {
-        j++;
-    }
-
-    m_maximumVoiceDifference = j * 12;
-    setCutOffPercentage(CutOffScaler);
+    m_analyzer.setListener(this);
+    m_analyzer.setSpectrumBuffer(&m_spectrumBuffer);
 }
 
 
 /*!
-  Opens the parent QIODevice. Sets up the analysation parameters.
+  Opens the parent QIODevice.
 */
-void VoiceAnalyzer::start(qreal frequency)
+void VoiceAnalyzer::start()
 {
-    setFrequency(frequency);
     open(QIODevice::WriteOnly);
 }
 
 
 /*!
   Closes the parent QIODevice, thus the voice is not analysed anymore.
-  Resets the m_samples QList.
+  Drops the samples collected so far.
 */
 void VoiceAnalyzer::stop()
 {
-    m_samples.clear();
-    m_samples.reserve(m_totalSampleCount);
+    m_analyzer.reset();
     close();
 }
 
@@ -102,40 +67,54 @@ qint64 VoiceAnalyzer::readData(char *data, qint64 maxlen)
 
 
 /*!
-  Called when data is obtained. Stores each m_stepSize sample into a QList
-  to be analysed. Returns the amount of data written.
+  Called when data is obtained. Passes the data to the analyzer. Returns the
+  amount of data written.
 */
 qint64 VoiceAnalyzer::writeData(const char *data, qint64 maxlen)
 {
-    const int channelBytes = m_format.sampleSize() / 8;
-    int sampleSize = m_format.channels() * channelBytes;
-    int m_stepSizeInBytes = m_stepSize*sampleSize;
+    return m_analyzer.write(data, maxlen);
+}
+
+
+/*!
+  Reads the data from \a device, of which \a bytesReady bytes are ready, in
+  blocks of blockSize() bytes and passes them to the analyzer. A partial
+  block is left in the device for the next call. Returns the amount of data
+  read.
+*/
+qint64 VoiceAnalyzer::readBlocks(QIODevice *device, qint64 bytesReady)
+{
+    const int blockSize = (this->blockSize() > 0)
+            ? this->blockSize() : int(bytesReady);
 
-    // assert that each sample fits fully into the data
-    Q_ASSERT((m_position % sampleSize) == 0);
+    if (m_block.size() < blockSize) {
+        m_block.resize(blockSize);
+    }
 
-    const uchar *ptr = reinterpret_cast<const uchar *>(data);
+    qint64 retval = 0;
 
-    while (m_position < maxlen) {
-        if (m_samples.size() < m_totalSampleCount) {
-            m_samples.append(getValueInt16(ptr+m_position));
-        }
-        else {
-            analyzeVoice();
-            m_samples.clear();
-            m_samples.reserve(m_totalSampleCount);
+    while (blockSize > 0 && bytesReady - retval >= blockSize) {
+        const qint64 length = device->read(m_block.data(), blockSize);
 
-            // fast forward position to the first position after maxlen or to the maxlen
-            m_position += ((m_stepSizeInBytes - 1 + maxlen - m_position) /
-                           m_stepSizeInBytes) * m_stepSizeInBytes;
+        if (length <= 0) {
             break;
         }
 
-        m_position += m_stepSizeInBytes;
+        m_analyzer.write(m_block.constData(), length);
+        retval += length;
     }
 
-    m_position -= maxlen;
-    return maxlen;
+    return retval;
+}
+
+
+/*!
+  Returns the size of the blocks read by readBlocks() in bytes, a capture
+  period, or 0 if the capture period is not known.
+*/
+int VoiceAnalyzer::blockSize() const
+{
+    return m_analyzer.capturePeriod() * m_analyzer.format().bytesPerFrame();
 }
 
 
@@ -144,7 +123,7 @@ qint64 VoiceAnalyzer::writeData(const char *data, qint64 maxlen)
 */
 qreal VoiceAnalyzer::frequency()
 {
-    return m_frequency;
+    return m_analyzer.frequency();
 }
 
 
@@ -153,7 +132,7 @@ qreal VoiceAnalyzer::frequency()
 */
 int VoiceAnalyzer::getMaximumVoiceDifference()
 {
-    return m_maximumVoiceDifference;
+    return m_analyzer.maximumVoiceDifference();
 }
 
 
@@ -162,155 +141,190 @@ int VoiceAnalyzer::getMaximumVoiceDifference()
 */
 int VoiceAnalyzer::getMaximumPrecisionPerNote()
 {
-    return PrecisionPerNote;
+    return m_analyzer.maximumPrecisionPerNote();
 }
 
 
 /*!
-  Sets the target frequency to \a frequency.
+  Returns the tracked noise floor in decibels relative to the full scale.
 */
-void VoiceAnalyzer::setFrequency(qreal frequency)
+qreal VoiceAnalyzer::noiseFloorLevel() const
 {
-    Q_ASSERT(frequency > 0); // Avoid division by zero
-    qDebug() << "VoiceAnalyzer::setFrequency():" << frequency;
+    return m_analyzer.noiseFloorLevel();
+}
 
-    m_stepSize = (qreal)(1.0 * m_format.sampleRate()
-                         / (TargetFrequencyParameter * 2 * frequency));
-    m_frequency = frequency;
+
+/*!
+  Returns the work counters of the analyzer.
+*/
+const PitchAnalyzerStatistics &VoiceAnalyzer::statistics() const
+{
+    return m_analyzer.statistics();
 }
 
 
 /*!
-  Takes \a cutoff, a number between 0 and 1, scales it with CutOffScaler,
-  multiplies it with maximum density, and then gives it to the fft helper.
+  Sets the strings to be analysed to the strings of \a tuning.
 */
-void VoiceAnalyzer::setCutOffPercentage(qreal cutoff)
+void VoiceAnalyzer::setTuning(const Tuning &tuning)
 {
-    qDebug() << "VoiceAnalyzer::setCutOffPercentage():" << cutoff;
-    cutoff = CutOffScaler * cutoff;
+    qDebug() << "VoiceAnalyzer::setTuning():" << tuning.name().c_str();
+    m_analyzer.setTuning(tuning);
+}
 
-    if (m_format.sampleSize() == 8) {
-        float t = cutoff * m_totalSampleCount * M_MAX_AMPLITUDE_8BIT_SIGNED;
-        m_fftHelper->setCutOffForDensity(t);
-    }
-    else if (m_format.sampleSize() == 16) {
-        float t = cutoff * m_totalSampleCount * M_MAX_AMPLITUDE_16BIT_SIGNED;
-        m_fftHelper->setCutOffForDensity(t);
-    }
+
+/*!
+  Schedules the frames to end at the end of the periods of \a sampleCount
+  sample frames in which the audio input device delivers the data, 0 if
+  not known.
+*/
+void VoiceAnalyzer::setCapturePeriod(int sampleCount)
+{
+    qDebug() << "VoiceAnalyzer::setCapturePeriod():" << sampleCount;
+    m_analyzer.setCapturePeriod(sampleCount);
 }
 
 
 /*!
-  Interprets \a ptr as a pointer to int value and returns it.
+  Returns the number of sample frames between two analyzed frames, or 0 if
+  the capture period is not known.
 */
-qint16 VoiceAnalyzer::getValueInt16(const uchar *ptr)
+int VoiceAnalyzer::hopSize() const
 {
-    qint16 realValue(0);
+    return m_analyzer.hopSize();
+}
 
-    if (m_format.sampleSize() == 8)
-    {
-        const qint16 value = *reinterpret_cast<const quint8*>(ptr);
 
-        if (m_format.sampleType() == QAudioFormat::UnSignedInt) {
-            realValue = value - M_MAX_AMPLITUDE_8BIT_SIGNED - 1;
-        }
-        else if (m_format.sampleType() == QAudioFormat::SignedInt) {
-            realValue = value;
-        }
-    }
-    else if (m_format.sampleSize() == 16) {
-        qint16 value(0);
+/*!
+  Lets the analyzer skip frames while the readings are stable or silent if
+  \a powerSavingEnabled is true. An onset restores the full rate.
+*/
+void VoiceAnalyzer::setPowerSavingEnabled(bool powerSavingEnabled)
+{
+    qDebug() << "VoiceAnalyzer::setPowerSavingEnabled():" << powerSavingEnabled;
+    m_analyzer.setPowerSavingEnabled(powerSavingEnabled);
+}
 
-        if (m_format.byteOrder() == QAudioFormat::LittleEndian)
-            value = qFromLittleEndian<quint16>(ptr);
-        else
-            value = qFromBigEndian<quint16>(ptr);
 
-        if (m_format.sampleType() == QAudioFormat::UnSignedInt) {
-            realValue = value - M_MAX_AMPLITUDE_16BIT_SIGNED;
-        }
-        else if (m_format.sampleType() == QAudioFormat::SignedInt) {
-            realValue = value;
-        }
-    }
+/*!
+  Enables the strobe mode if \a strobeModeEnabled is true. In the strobe
+  mode the frames overlap, and the difference from the target measured from
+  the phase of the voice is reported with the strobeMeasured() signal, or
+  the strobeLost() signal until there is one.
+*/
+void VoiceAnalyzer::setStrobeModeEnabled(bool strobeModeEnabled)
+{
+    qDebug() << "VoiceAnalyzer::setStrobeModeEnabled():" << strobeModeEnabled;
+    m_analyzer.setStrobeModeEnabled(strobeModeEnabled);
+}
 
-    return realValue;
+
+/*!
+  Returns the buffer, to which the spectrum of each analyzed frame is
+  published. The spectrumUpdated() signal is emitted after each one.
+*/
+SpectrumBuffer *VoiceAnalyzer::spectrumBuffer()
+{
+    return &m_spectrumBuffer;
 }
 
 
 /*!
-  Analyzes the voice frequency and emits appropriate signals.
+  Sets the target to the string at \a string in the tuning.
 */
-void VoiceAnalyzer::analyzeVoice()
+void VoiceAnalyzer::setString(int string)
 {
-    m_fftHelper->calculateFFT(m_samples);
-    int index = m_fftHelper->getMaximumDensityIndex();
-
-    // If index == -1
-    if (index == -1) {
-        // The voice is to be filtered away.
-        // Emit the lowVoice signal and return.
-        qDebug() << "VoiceAnalyzer::analyzeVoice(): Low voice";
-        emit lowVoice();
-        return;
-    }
+    qDebug() << "VoiceAnalyzer::setString():" << string;
+    m_analyzer.setString(string);
+}
 
-    // Else, continue
 
-    // Let the correctIndex to be the nearest index corresponding to the
-    // correct frequency.
-    qreal stepSizeInFrequency = (qreal)m_format.sampleRate()
-            / (m_totalSampleCount * m_stepSize);
-    qreal newFrequency = qreal(index) * stepSizeInFrequency;
+/*!
+  Sets the target frequency to \a frequency.
+*/
+void VoiceAnalyzer::setFrequency(qreal frequency)
+{
+    qDebug() << "VoiceAnalyzer::setFrequency():" << frequency;
+    m_analyzer.setFrequency(frequency);
+}
 
-    // Calculate the nearest index corresponding to the correct frequency.
-    int correctIndex = qRound(m_frequency / stepSizeInFrequency);
-    qreal value = 0;
 
-    // If the obtained frequency is more than
-    // log_2(TargetFrequencyParameter) octaves less than the m_frequency:
+/*!
+  Takes \a cutoff, a number between 0 and 1, and gives it to the analyzer.
+*/
+void VoiceAnalyzer::setCutOffPercentage(qreal cutoff)
+{
+    qDebug() << "VoiceAnalyzer::setCutOffPercentage():" << cutoff;
+    m_analyzer.setCutOffPercentage(cutoff);
+}
 
-    // Note:
-    // Instead of m_frequency/TargetFrequencyParameter > newFrequency,
-    // the comparison is done without a div instructions by
-    // m_frequency > newFrequency * TargetFrequencyParameter.
 
-    if (m_frequency > newFrequency * TargetFrequencyParameter) {
-        // Set the difference value to be -m_maximumVoiceDifference.
-        qDebug() << "VoiceAnalyzer::analyzeVoice(): Comparing (low):"
-                 << newFrequency  << m_frequency - stepSizeInFrequency * correctIndex
-                 << (m_frequency - stepSizeInFrequency * correctIndex) / stepSizeInFrequency;
-        value = -m_maximumVoiceDifference;
+/*!
+  Enables the auto mode if \a autoModeEnabled is true. In the auto mode all the
+  strings are analysed at once, and the detectedStringChanged() signal tells
+  from which string the voice difference is measured.
+*/
+void VoiceAnalyzer::setAutoModeEnabled(bool autoModeEnabled)
+{
+    qDebug() << "VoiceAnalyzer::setAutoModeEnabled():" << autoModeEnabled;
+    m_analyzer.setAutoModeEnabled(autoModeEnabled);
+    m_detectedString = -1;
+}
+
+
+/*!
+  Enables the chromatic mode if \a chromaticModeEnabled is true. In the
+  chromatic mode the nearest note, in semitones from C0, is reported with
+  the noteDetected() signal, and the voice difference is measured from it.
+*/
+void VoiceAnalyzer::setChromaticModeEnabled(bool chromaticModeEnabled)
+{
+    qDebug() << "VoiceAnalyzer::setChromaticModeEnabled():" << chromaticModeEnabled;
+    m_analyzer.setChromaticModeEnabled(chromaticModeEnabled);
+}
+
+
+/*!
+  Emits the signals corresponding to \a result.
+*/
+void VoiceAnalyzer::pitchAnalyzed(const PitchResult &result)
+{
+    if (!m_analyzer.chromaticModeEnabled()) {
+        emit spectrumUpdated();
+    }
+
+    if (m_analyzer.strobeModeEnabled()) {
+        if (result.hasStrobe) {
+            emit strobeMeasured(result.strobeCents, result.strobeBeat);
+        }
+        else {
+            emit strobeLost();
+        }
     }
-    // Else, if the obtained frequency is more than
-    // log_2(TargetFrequencyParameter) octaves more than the m_frequency:
-    else if (m_frequency * TargetFrequencyParameter < newFrequency) {
-        // Set the difference value to be m_maximumVoiceDifference.
-        qDebug() << "VoiceAnalyzer::analyzeVoice(): Comparing (high):"
-                 << newFrequency << m_frequency - stepSizeInFrequency * correctIndex
-                 << (m_frequency - stepSizeInFrequency * correctIndex) / stepSizeInFrequency;
-        value = m_maximumVoiceDifference;
+
+    if (result.isLowVoice) {
+        qDebug() << "VoiceAnalyzer::pitchAnalyzed(): Low voice";
+        emit lowVoice();
+        return;
     }
-    // Else:
-    else {
-        // Calculate the difference between the obtained and the correct
-        // frequency in tones.
-        // Use stepSizeInFrequency * correctIndex instead of
-        // m_frequency so that the value is zero when there is correct
-        // voice obtained. Set the difference value to be
-        // log(frequency / target frequency) * 12 / log(2).
-        value = log(newFrequency / (stepSizeInFrequency * correctIndex)) * 12 / M_LN2;
-        qDebug() << "VoiceAnalyzer::analyzeVoice(): Comparing:"
-                 << newFrequency << m_frequency - stepSizeInFrequency * correctIndex
-                 << (m_frequency - stepSizeInFrequency * correctIndex) / stepSizeInFrequency;
+
+    if (m_analyzer.autoModeEnabled() && result.stringIndex != -1
+            && result.stringIndex != m_detectedString) {
+        m_detectedString = result.stringIndex;
+        emit detectedStringChanged(m_detectedString);
+    }
+
+    if (result.note != -1) {
+        emit noteDetected(result.note, result.smoothedVoiceDifference);
     }
 
-    // Emit voiceDifferenceChanged signal.
-    qDebug() << "VoiceAnalyzer::analyzeVoice(): Voice difference changed:" << value;
-    emit voiceDifferenceChanged(value);
+    qDebug() << "VoiceAnalyzer::pitchAnalyzed(): Voice difference changed:"
+             << result.voiceDifference << "at" << result.frequency;
+    emit voiceDifferenceChanged(result.voiceDifference);
+    emit smoothedVoiceDifferenceChanged(result.smoothedVoiceDifference,
+                                        result.confidence);
 
-    // If the correctIndex is index, emit the correctFrequency signal.
-    if (correctIndex == index) {
+    if (result.isCorrectFrequency) {
         emit correctFrequency();
     }
 }
@@ -5,14 +5,15 @@
 #ifndef VOICEANALYZER_H
 #define VOICEANALYZER_H
 
+#include <QtCore/QByteArray>
 #include <QtCore/QIODevice>
 #include <QtCore/QVariant>
 #include <QtMultimediaKit/QAudioFormat>
 
-class FastFourierTransformer;
+#include "pitchanalyzer.h"
 
 
-class VoiceAnalyzer : public QIODevice
+class VoiceAnalyzer : public QIODevice, private PitchAnalyzerListener
 {
     Q_OBJECT
 
@@ -20,36 +21,50 @@ public:
     explicit VoiceAnalyzer(const QAudioFormat &format, QObject *parent = 0);
 
 public:
-    void start(qreal frequency);
+    void start();
     void stop();
     qint64 readData(char *data, qint64 maxlen);
     qint64 writeData(const char *data, qint64 maxlen);
+    qint64 readBlocks(QIODevice *device, qint64 bytesReady);
+    int blockSize() const;
     qreal frequency();
     int getMaximumVoiceDifference();
     int getMaximumPrecisionPerNote();
+    qreal noiseFloorLevel() const;
+    const PitchAnalyzerStatistics &statistics() const;
+    void setTuning(const Tuning &tuning);
+    void setString(int string);
+    void setCapturePeriod(int sampleCount);
+    int hopSize() const;
+    void setPowerSavingEnabled(bool powerSavingEnabled);
+    void setStrobeModeEnabled(bool strobeModeEnabled);
+    SpectrumBuffer *spectrumBuffer();
 
 public slots:
     void setFrequency(qreal frequency);
     void setCutOffPercentage(qreal cutoff);
+    void setAutoModeEnabled(bool autoModeEnabled);
+    void setChromaticModeEnabled(bool chromaticModeEnabled);
 
-private:
-    qint16 getValueInt16(const uchar *ptr);
-    void analyzeVoice();
+private: // From PitchAnalyzerListener
+    void pitchAnalyzed(const PitchResult &result);
 
 signals:
     void voiceDifferenceChanged(qreal frequency);
+    void smoothedVoiceDifferenceChanged(qreal voiceDifference, qreal confidence);
+    void detectedStringChanged(int string);
+    void noteDetected(int note, qreal voiceDifference);
     void correctFrequency();
     void lowVoice();
+    void spectrumUpdated();
+    void strobeMeasured(qreal cents, qreal beat);
+    void strobeLost();
 
 private:
-    FastFourierTransformer *m_fftHelper; // Owned
-    const QAudioFormat m_format;
-    QList<qint16> m_samples;
-    int m_totalSampleCount;
-    int m_maximumVoiceDifference;
-    int m_stepSize;
-    qreal m_frequency;
-    qint64 m_position;
+    SpectrumBuffer m_spectrumBuffer;
+    PitchAnalyzer m_analyzer;
+    QByteArray m_block; // Reused by readBlocks()
+    int m_detectedString;
 };
 
 
@@ -5,17 +5,14 @@
 #include "voicegenerator.h"
 
 #include <QtCore/QDebug>
-#include <QtCore/qmath.h>
-#include <QtCore/qendian.h>
 
-#include "constants.h"
-
-const int BufferSizeMilliseconds(100);
+#include "audioformatconverter.h"
 
 
 /*!
   \class VoiceGenerator
-  \brief Generates sound according to the set frequency and amplitude.
+  \brief Adapts ToneGenerator to a QIODevice providing the data for the audio
+         output device.
 */
 
 
@@ -27,22 +24,8 @@ VoiceGenerator::VoiceGenerator(const QAudioFormat &format,
                                qreal amplitude,
                                QObject *parent)
     : QIODevice(parent),
-      m_format(format),
-      m_position(0),
-      m_maxPosition(0),
-      m_amplitude(amplitude),
-      m_frequency(FrequencyE)
+      m_generator(toPcmFormat(format), frequency, amplitude)
 {
-    Q_ASSERT(m_format.sampleSize() % 8 == 0);
-
-    int sampleBytes = m_format.channels() * (m_format.sampleSize() / 8);
-
-    // + 1 to round up, just to be sure that all samples fit.
-    qint64 samplesInBuffer = m_format.sampleRate()
-                             * BufferSizeMilliseconds / 1000 + 1;
-    qint64 length = samplesInBuffer * sampleBytes;
-    m_buffer.resize(length);
-    setFrequency(frequency);
 }
 
 
@@ -60,11 +43,8 @@ VoiceGenerator::~VoiceGenerator()
 */
 void VoiceGenerator::setFrequency(qreal frequency)
 {
-    Q_ASSERT(frequency != 0);
-    Q_ASSERT(1 / frequency < BufferSizeMilliseconds);
-    m_frequency = frequency;
-    refreshData();
-    qDebug() << "VoiceGenerator::setFrequency(): Frequency set to" << m_frequency;
+    m_generator.setFrequency(frequency);
+    qDebug() << "VoiceGenerator::setFrequency(): Frequency set to" << frequency;
 }
 
 
@@ -73,7 +53,63 @@ void VoiceGenerator::setFrequency(qreal frequency)
 */
 qreal VoiceGenerator::frequency()
 {
-    return m_frequency;
+    return m_generator.frequency();
+}
+
+
+/*!
+  Renders the reference tones of the strings of \a tuning.
+*/
+void VoiceGenerator::setTuning(const Tuning &tuning)
+{
+    m_generator.setTuning(tuning.targetFrequencies());
+    qDebug() << "VoiceGenerator::setTuning(): Tones rendered for"
+             << tuning.name().c_str();
+}
+
+
+/*!
+  Sets the voice to the pre-rendered tone of the string at \a string in the
+  tuning.
+*/
+void VoiceGenerator::setString(int string)
+{
+    m_generator.setString(string);
+    qDebug() << "VoiceGenerator::setString(): Frequency set to"
+             << m_generator.frequency();
+}
+
+
+/*!
+  Sets the voice to \a voice, a sine or a plucked string.
+*/
+void VoiceGenerator::setVoice(ToneGenerator::Voice voice)
+{
+    m_generator.setVoice(voice);
+    qDebug() << "VoiceGenerator::setVoice():" << voice;
+}
+
+
+/*!
+  Sets the amplitudes of the harmonics of the voice to \a harmonics, from the
+  fundamental. The tones of the tuning are rendered again.
+*/
+void VoiceGenerator::setHarmonics(const std::vector<double> &harmonics)
+{
+    m_generator.setHarmonics(harmonics);
+    qDebug() << "VoiceGenerator::setHarmonics():" << harmonics.size()
+             << "harmonics";
+}
+
+
+/*!
+  Plays the chord of \a notes of the strings of the tuning at once. An
+  empty \a notes plays the selected string again.
+*/
+void VoiceGenerator::setChord(const std::vector<ToneGenerator::ChordNote> &notes)
+{
+    m_generator.setChord(notes);
+    qDebug() << "VoiceGenerator::setChord():" << notes.size() << "notes";
 }
 
 
@@ -83,29 +119,7 @@ qreal VoiceGenerator::frequency()
 */
 qint64 VoiceGenerator::readData(char *data, qint64 maxlen)
 {
-    qint64 total(0);
-    qint64 chunk(0);
-
-    while (total < maxlen) {
-        if (maxlen - total >= m_maxPosition - m_position) {
-            // the needed buffer is longer than the currently
-            // available buffer from m_position to the m_maxPosition
-            chunk = m_maxPosition - m_position;
-            memcpy(data, m_buffer.constData() + m_position, chunk);
-            m_position = 0;
-        }
-        else {
-            // we can copy the needed data directly, and the loop will end
-            chunk = maxlen - total;
-            memcpy(data, m_buffer.constData() + m_position, chunk);
-            m_position = (m_position + chunk) % m_maxPosition;
-        }
-
-        data += chunk;
-        total += chunk;
-    }
-
-    return total;
+    return m_generator.read(data, maxlen);
 }
 
 
@@ -127,7 +141,7 @@ qint64 VoiceGenerator::writeData(const char *data, qint64 maxlen)
 */
 qint64 VoiceGenerator::bytesAvailable() const
 {
-    return m_maxPosition + QIODevice::bytesAvailable();
+    return m_generator.bytesAvailable() + QIODevice::bytesAvailable();
 }
 
 
@@ -136,122 +150,34 @@ qint64 VoiceGenerator::bytesAvailable() const
 */
 void VoiceGenerator::setAmplitude(qreal amplitude)
 {
-    Q_ASSERT(amplitude >= 0);
     qDebug() << "VoiceGenerator::setAmplitude():" << amplitude;
-    m_amplitude = amplitude;
-    refreshData();
-}
-
-
-/*!
-  Opens the parent QIODevice.
-*/
-void VoiceGenerator::start()
-{
-    open(QIODevice::ReadOnly);
+    m_generator.setAmplitude(amplitude);
 }
 
 
 /*!
-  Closes the parent QIODevice. Resets the m_position to zero.
+  Plucks the plucked voice again.
 */
-void VoiceGenerator::stop()
+void VoiceGenerator::pluck()
 {
-    close();
-    m_position = 0;
+    m_generator.pluck();
 }
 
 
 /*!
-  Stores \a realValue into bytes pointed by \a ptr as an int value.
-  Align-safe.
+  Opens the parent QIODevice.
 */
-void VoiceGenerator::setValue(uchar *ptr, qreal realValue)
+void VoiceGenerator::start()
 {
-    if (m_format.sampleSize() == 8)
-    {
-        quint8 value(0);
-
-        if (m_format.sampleType() == QAudioFormat::UnSignedInt) {
-            value = static_cast<quint8>(
-                        qRound((1.0 + realValue) / 2
-                               * M_MAX_AMPLITUDE_8BIT_UNSIGNED));
-        }
-        else if (m_format.sampleType() == QAudioFormat::SignedInt) {
-            value = static_cast<qint8>(
-                        qRound(realValue
-                               * M_MAX_AMPLITUDE_8BIT_SIGNED));
-        }
-
-        *reinterpret_cast<quint8*>(ptr) = value;
-    }
-    else if (m_format.sampleSize() == 16) {
-        quint16 value(0);
-
-        if (m_format.sampleType() == QAudioFormat::UnSignedInt) {
-            value = static_cast<quint16>(
-                        qRound((1.0 + realValue) / 2
-                               * M_MAX_AMPLITUDE_16BIT_UNSIGNED));
-        }
-        else if (m_format.sampleType() == QAudioFormat::SignedInt) {
-            value = static_cast<qint16>(
-                        qRound(realValue
-                               * M_MAX_AMPLITUDE_16BIT_SIGNED));
-        }
-
-        if (m_format.byteOrder() == QAudioFormat::LittleEndian) {
-            qToLittleEndian<qint16>(value, ptr);
-        }
-        else {
-            qToBigEndian<qint16>(value, ptr);
-        }
-    }
+    open(QIODevice::ReadOnly);
 }
 
 
 /*!
-  Generates voice data corresponding a sine voice with target frequency.
-  The number of data generated is calculated and stored to m_maxPosition.
+  Closes the parent QIODevice. Rewinds the generator.
 */
-void VoiceGenerator::refreshData()
+void VoiceGenerator::stop()
 {
-    if (m_frequency == 0) {
-        // Let's not divide by zero.
-        return;
-    }
-
-    const int channelBytes = m_format.sampleSize() / 8;
-    const int sampleSize = m_format.channels() * channelBytes;
-    const qint64 voiceOscillationsInBuffer = BufferSizeMilliseconds
-                                         * m_frequency / 1000;
-    const qint64 voiceSamplesInBuffer = voiceOscillationsInBuffer
-                                   * m_format.sampleRate() / m_frequency;
-    m_maxPosition = voiceSamplesInBuffer * sampleSize;
-    qint64 dataGenerationLength = m_buffer.size();
-
-
-    Q_ASSERT(m_maxPosition % (sampleSize) == 0);
-    Q_ASSERT(dataGenerationLength <= m_buffer.size());
-
-    uchar *ptr = reinterpret_cast<uchar *>(m_buffer.data());
-    int sampleIndex = 0;
-
-    while (dataGenerationLength > 0) {
-        qreal realValue = 0;
-
-        if (sampleIndex < voiceSamplesInBuffer) {
-            realValue =
-                m_amplitude * qSin(2.0f * M_PI * m_frequency
-                * qreal(sampleIndex % m_format.sampleRate())
-                / m_format.sampleRate());
-        }
-
-        for (int i=0; i<m_format.channels(); ++i) {
-            setValue(ptr, realValue);
-            ptr += channelBytes;
-            dataGenerationLength -= channelBytes;
-        }
-
-        ++sampleIndex;
-    }
+    close();
+    m_generator.reset();
 }
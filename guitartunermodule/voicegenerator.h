@@ -5,10 +5,12 @@
 #ifndef VOICEGENERATOR_H
 #define VOICEGENERATOR_H
 
-#include <QtCore/QByteArray>
 #include <QtCore/QIODevice>
 #include <QtMultimediaKit/QAudioFormat>
 
+#include "tonegenerator.h"
+#include "tuning.h"
+
 
 class VoiceGenerator : public QIODevice
 {
@@ -24,27 +26,23 @@ public:
 public:
     void setFrequency(qreal frequency);
     qreal frequency();
+    void setTuning(const Tuning &tuning);
+    void setString(int string);
+    void setVoice(ToneGenerator::Voice voice);
+    void setHarmonics(const std::vector<double> &harmonics);
+    void setChord(const std::vector<ToneGenerator::ChordNote> &notes);
     qint64 readData(char *data, qint64 maxlen);
     qint64 writeData(const char *data, qint64 maxlen);
     qint64 bytesAvailable() const;
 
 public slots:
     void setAmplitude(qreal amplitude);
+    void pluck();
     void start();
     void stop();
 
-private:
-    void setValue(uchar *ptr, qreal realValue);
-    void refreshData();
-
 private:  // Data
-    const QAudioFormat m_format;
-    QByteArray m_buffer; // Buffer to store the data
-    qint64 m_position; // Current position in buffer
-    qint64 m_maxPosition; // Max position depends on the sample rate of
-                          // format and the frequency of voice
-    qreal m_amplitude;
-    qreal m_frequency;
+    ToneGenerator m_generator;
 };
 
 
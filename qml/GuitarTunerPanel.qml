@@ -38,19 +38,20 @@ Item {
             meter.backlightOn = true;
             stringIndicator.turnGlowingOn();
         }
-        onVoiceDifferenceChanged: {
-            // Forward the voice difference value to the meter and turn the
-            // backlight on to indicate that the analyzer is active.
-            meter.handleVoiceDifferenceChanged(voiceDifference);
-            meter.backlightOn = true;
+        onMeterValueChanged: {
+            // Forward the voice difference value tracked over frames to the
+            // meter. The engine changes it at most once per rendered frame.
+            meter.value = meterValue;
+        }
+        onMeterActiveChanged: {
+            // Turn the backlight on to indicate that the analyzer is active,
+            // and off when the voice is too low.
+            meter.backlightOn = meterActive;
         }
         onAutoDetectedStringChanged: {
             console.debug("GuitarTunerPanel::onAutoDetectedStringChanged(): " + string);
             stringIndicator.stringNote = string;
         }
-        onLowVoice: {
-            meter.backlightOn = false;
-        }
 
         onSettingsRestored: ioControls.initValues();
     }
@@ -17,22 +17,15 @@ Item {
     */
     property bool backlightOn: false
 
+    /*!
+      \qmlproperty Meter::value
+      \brief The value to point at. The pointer springs towards the latest
+             value, so it should be set at most once per frame.
+    */
     property real value: 0
     property real minValue: -12
     property real maxValue: 12
 
-    /*!
-      Reacts to \a voiceDifference and moves the pointer accordingly.
-    */
-    function handleVoiceDifferenceChanged(voiceDifference)
-    {
-        value = voiceDifference;
-
-        pointerImage.angle = (((value - minValue) / (maxValue - minValue)) *
-                              (pointerImage.angleMax - pointerImage.angleMin)) +
-                             pointerImage.angleMin;
-    }
-
     Image {
         id: meterBackgroundImage
         anchors.fill: parent
@@ -76,7 +69,9 @@ Item {
     Image {
         id: pointerImage
 
-        property real angle: 0
+        property real angle: (((meter.value - meter.minValue) /
+                                (meter.maxValue - meter.minValue)) *
+                               (angleMax - angleMin)) + angleMin
         property real angleMax: -40
         property real angleMin: 40
 
@@ -3,15 +3,21 @@
  */
 
 #include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
 #include <QtWidgets/QApplication>
 #include <QtQml/QQmlContext>
 #include <QtQml/QQmlEngine>
 #include <QtQuick/QQuickView>
 
+#include "guitartuner.h"
 #include "guitartunerplugin.h"
 
 int main(int argc, char *argv[])
 {
+    // Measures the startup, see below.
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
     QApplication app(argc, argv);
 
     // Construct and register the guitar tuner plug-in
@@ -35,6 +41,38 @@ int main(int argc, char *argv[])
     QObject::connect(view.engine(), SIGNAL(quit()), &app, SLOT(quit()));
     view.setSource(QUrl("qrc:/main.qml"));
 
+    // Report the time from the start to the first rendered frame and to the
+    // first analyzed frame.
+    bool isFirstFrame(true);
+    bool isFirstAnalysis(true);
+
+    QObject::connect(&view, &QQuickWindow::frameSwapped, [&]() {
+        if (isFirstFrame) {
+            isFirstFrame = false;
+            qDebug() << "Startup: First frame in" << startupTimer.elapsed() << "ms";
+        }
+    });
+
+    GuitarTuner *guitarTuner = view.rootObject()
+            ? view.rootObject()->findChild<GuitarTuner *>() : 0;
+
+    if (guitarTuner) {
+        const auto reportFirstAnalysis = [&]() {
+            if (isFirstAnalysis) {
+                isFirstAnalysis = false;
+                qDebug() << "Startup: First analysis in"
+                         << startupTimer.elapsed() << "ms";
+            }
+        };
+
+        QObject::connect(guitarTuner, &GuitarTuner::spectrumUpdated,
+                         reportFirstAnalysis);
+        QObject::connect(guitarTuner, &GuitarTuner::lowVoice,
+                         reportFirstAnalysis);
+        QObject::connect(guitarTuner, &GuitarTuner::noteDetected,
+                         reportFirstAnalysis);
+    }
+
 #if defined(Q_OS_SYMBIAN) || defined(MEEGO_EDITION_HARMATTAN) || defined(Q_WS_SIMULATOR)
     view.showFullScreen();
     qDebug() << "Running on mobile or in the simulator.";